@@ -138,6 +138,10 @@ class TrainData(object):
         self.remove=True    
         self.weight=False
         
+        #means and norms in one C++ pass, only for float and vector<float>
+        #branches and if make_means is not overloaded
+        self.streamingmeans=False
+        
         self.clear()
         
         self.reduceTruth(None)
@@ -635,7 +639,8 @@ class TrainData(object):
         return meanNormProd(nparray)
         
     def produceMeansFromRootFile(self,filename, limit=500000):
-        from preprocessing import meanNormProd
+        if getattr(self, 'streamingmeans', False) and type(self).make_means is TrainData.make_means:
+            return self.produceMeansFromRootFileStreaming(filename, limit)
         nparray = self.readTreeFromRootToTuple(filename, limit=limit)
         means = numpy.array([],dtype='float32')
         if len(nparray):
@@ -644,6 +649,16 @@ class TrainData(object):
         del nparray
         return means
     
+    def produceMeansFromRootFileStreaming(self,filename, limit=500000):
+        from preprocessing import meanNormStatistics, meanNormFromStatistics
+        branches = [b for b in set(self.allbranchestoberead) if len(b)]
+        if not len(branches):
+            return numpy.array([],dtype='float32')
+        fileTimeOut(filename,120)
+        #streaming statistics in C++, no need to read the tuple
+        stats = meanNormStatistics(filename, sorted(branches), maxentries=limit, treename=self.treename)
+        return meanNormFromStatistics(stats)
+    
     #overload if necessary
     def make_empty_weighter(self):
         weighter = Weighter() 
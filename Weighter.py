@@ -88,33 +88,41 @@ class Weighter(object):
         if len(self.truth_red_fusion)<1:
             self.truth_red_fusion=['']
         
+    def _columns(self,Tuple):
+        '''
+        x, y and the class labels as contiguous arrays for c_weighter.
+        Without classes, all jets are in the one class
+        '''
+        x=np.ascontiguousarray(Tuple[self.nameX],dtype='float64')
+        y=np.ascontiguousarray(Tuple[self.nameY],dtype='float64')
+        if len(self.classes)==1 and len(self.classes[0])==0:
+            labels=np.ones((len(x),1),dtype='float32')
+        else:
+            labels=np.ascontiguousarray(np.stack([Tuple[c] for c in self.classes],axis=1),dtype='float32')
+        return x,y,labels
+    
+    def _binMap(self,maps):
+        return np.ascontiguousarray(np.stack(maps),dtype='float64')
+    
     def addDistributions(self,Tuple, norm_h = True):
-        selidxs=[]
+        from DeepJetCore.compiled import c_weighter
         
-        ytuple=Tuple[self.nameY]
-        xtuple=Tuple[self.nameX]
+        x,y,labels=self._columns(Tuple)
+        self.xedges=np.array(self.axisX,dtype='float64')
+        self.yedges=np.array(self.axisY,dtype='float64')
+        hists=np.zeros((len(self.classes),len(self.xedges)-1,len(self.yedges)-1),dtype='float64')
+        c_weighter.fillHistograms(x,y,labels,self.xedges,self.yedges,hists,0)
         
-        useonlyoneclass=len(self.classes)==1 and len(self.classes[0])==0
+        if norm_h:#density, as numpy.histogram2d
+            area=np.outer(np.diff(self.xedges),np.diff(self.yedges))
+            for i in range(len(hists)):
+                hists[i]=hists[i]/hists[i].sum()/area
         
-        if not useonlyoneclass:
-            labeltuple=Tuple[self.classes]
-            for c in self.classes:
-                selidxs.append(labeltuple[c]>0)
-        else:
-            selidxs=[np.zeros(len(xtuple),dtype='int')<1]
-                    
-        for i, label in enumerate(self.classes):
-            #print('axis-X binning :')
-            #print(self.axisX)
-            #print('axis-Y binning :')
-            #print(self.axisY)
-            tmphist,xe,ye=np.histogram2d(xtuple[selidxs[i]],ytuple[selidxs[i]],[self.axisX,self.axisY],normed=norm_h)
-            self.xedges=xe
-            self.yedges=ye
+        for i in range(len(self.classes)):
             if len(self.distributions)==len(self.classes):
-                self.distributions[i]=self.distributions[i]+tmphist
+                self.distributions[i]=self.distributions[i]+hists[i]
             else:
-                self.distributions.append(tmphist)
+                self.distributions.append(hists[i])
                         
     def printHistos(self,outdir):
         def plotHist(hist,outname, histname):
@@ -183,14 +191,8 @@ class Weighter(object):
             self.red_distributions = temp
     
         def divideHistos(a,b):
-            out=np.array(a)
-            for i in range(a.shape[0]):
-                for j in range(a.shape[1]):
-                    if b[i][j]:
-                        out[i][j]=a[i][j]/b[i][j]
-                    else:
-                        out[i][j]=-10
-            return out
+            with np.errstate(divide='ignore', invalid='ignore'):
+                return np.where(b!=0, a/np.where(b!=0,b,1), -10.)
                 
         reweight_threshold = 15
         max_weight = 1
@@ -259,78 +261,34 @@ class Weighter(object):
                 self.binweights[i]=self.binweights[i]/np.average(self.binweights[i])
               
     def createNotRemoveIndices(self,Tuple):
+        from DeepJetCore.compiled import c_weighter
         
         if len(self.removeProbabilties) <1:
             raise Exception('removeProbabilties bins not initialised. Cannot create indices per jet')
         
-        tuplelength=len(Tuple)
-        
-        notremove=np.zeros(tuplelength)
-        counter=0
-        xaverage=[]
-        norm=[]
-        yaverage=[]
-        
-        useonlyoneclass=len(self.classes)==1 and len(self.classes[0])==0
-        
-        for c in self.classes:
-            xaverage.append(0)
-            norm.append(0)
-            yaverage.append(0)
-        
-        for jet in iter(Tuple[self.Axixandlabel]):
-            binX =  self.getBin(jet[self.nameX], self.axisX)
-            binY =  self.getBin(jet[self.nameY], self.axisY)
-            
-            for index, classs in enumerate(self.classes):
-                if  useonlyoneclass or 1 == jet[classs]:
-                    rand=np.random.ranf()
-                    prob = self.removeProbabilties[index][binX][binY]
-                    
-                    if rand < prob and index != self.refclassidx:
-                        #print('rm  ',index,self.refclassidx,jet[classs],classs)
-                        notremove[counter]=0
-                    else:
-                        #print('keep',index,self.refclassidx,jet[classs],classs)
-                        notremove[counter]=1
-                        xaverage[index]+=jet[self.nameX]
-                        yaverage[index]+=jet[self.nameY]
-                        norm[index]+=1
-            
-                    counter += 1
-                    break
-            else:
-                counter += 1
-        
-            
-        if not len(notremove) == counter:
-            raise Exception("tuple length must match remove indices length. Probably a problem with the definition of truth classes in the ntuple and the TrainData class")
-        
-        
+        x,y,labels=self._columns(Tuple)
+        notremove=np.zeros(len(x))
+        #seeded from numpy, so np.random.seed keeps it reproducible
+        seed=np.random.randint(0,2**31)
+        c_weighter.notRemoveFlags(x,y,labels,
+                                  np.array(self.axisX,dtype='float64'),np.array(self.axisY,dtype='float64'),
+                                  self._binMap(self.removeProbabilties),
+                                  self.refclassidx,seed,notremove,0)
         return notremove
 
     
         
     def getJetWeights(self,Tuple):
-        countMissedJets = 0  
+        from DeepJetCore.compiled import c_weighter
+        
         if len(self.binweights) <1:
             raise Exception('weight bins not initialised. Cannot create weights per jet')
         
-        weight = np.zeros(len(Tuple))
-        jetcount=0
-        
-        useonlyoneclass=len(self.classes)==1 and len(self.classes[0])==0
-        
-        for jet in iter(Tuple[self.Axixandlabel]):
-
-            binX =  self.getBin(jet[self.nameX], self.axisX)
-            binY =  self.getBin(jet[self.nameY], self.axisY)
-            
-            for index, classs in enumerate(self.classes):
-                if 1 == jet[classs] or useonlyoneclass:
-                    weight[jetcount]=(self.binweights[index][binX][binY])
-                    
-            jetcount=jetcount+1        
+        x,y,labels=self._columns(Tuple)
+        weight = np.zeros(len(x))
+        c_weighter.jetWeights(x,y,labels,
+                              np.array(self.axisX,dtype='float64'),np.array(self.axisY,dtype='float64'),
+                              self._binMap(self.binweights),weight,0)
 
         print ('weight average: ',weight.mean())
         return weight
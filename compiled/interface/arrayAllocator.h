@@ -0,0 +1,153 @@
+/*
+ * arrayAllocator.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ARRAYALLOCATOR_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ARRAYALLOCATOR_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <new>
+#include <string>
+
+namespace djc{
+
+/*
+ * Allocation hook for simpleArray data.
+ * Each array remembers the allocator its data was allocated with and frees it
+ * with the same one, therefore allocators must live as long as the program
+ * (e.g. static objects).
+ * deallocate gets the same number of bytes that was requested.
+ *
+ * The default is chosen by the environment variable DJC_HUGEPAGES:
+ *  - not set:       64 byte aligned
+ *  - "transparent": 64 byte aligned, large arrays are 2MB aligned and
+ *                   advised to use transparent huge pages
+ *  - "explicit":    64 byte aligned, large arrays are mapped from the huge page
+ *                   pool (MAP_HUGETLB), falls back to transparent huge pages
+ *                   if the pool is exhausted
+ */
+struct arrayAllocator{
+    void * (*allocate)(size_t nbytes);
+    void (*deallocate)(void * p, size_t nbytes);
+};
+
+namespace allocators{
+
+const size_t alignment = 64;
+const size_t hugepagesize = (size_t)2 << 20;
+//arrays from this size on use huge pages if enabled
+const size_t hugepagethreshold = (size_t)32 << 20;
+
+inline size_t roundUp(size_t nbytes, size_t to){
+    if(!nbytes)
+        nbytes = 1;
+    return (nbytes + to - 1) / to * to;
+}
+
+inline void * aligned(size_t nbytes){
+    void * p = aligned_alloc(alignment, roundUp(nbytes, alignment));
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+inline void alignedFree(void * p, size_t){
+    free(p);
+}
+
+inline void * transparentHuge(size_t nbytes){
+    if(nbytes < hugepagethreshold)
+        return aligned(nbytes);
+    size_t mapped = roundUp(nbytes, hugepagesize);
+    void * p = aligned_alloc(hugepagesize, mapped);
+    if(!p)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    madvise(p, mapped, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+inline void transparentHugeFree(void * p, size_t){
+    free(p);
+}
+
+inline void * explicitHuge(size_t nbytes){
+    if(nbytes < hugepagethreshold)
+        return aligned(nbytes);
+    size_t mapped = roundUp(nbytes, hugepagesize);
+    void * p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(0, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if(p == MAP_FAILED){
+        p = mmap(0, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED)
+            throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        madvise(p, mapped, MADV_HUGEPAGE);
+#endif
+    }
+    return p;
+}
+inline void explicitHugeFree(void * p, size_t nbytes){
+    if(nbytes < hugepagethreshold)
+        free(p);
+    else
+        munmap(p, roundUp(nbytes, hugepagesize));
+}
+
+}//allocators
+
+inline const arrayAllocator * alignedArrayAllocator(){
+    static const arrayAllocator a = {&allocators::aligned, &allocators::alignedFree};
+    return &a;
+}
+
+inline const arrayAllocator * transparentHugePageArrayAllocator(){
+    static const arrayAllocator a = {&allocators::transparentHuge, &allocators::transparentHugeFree};
+    return &a;
+}
+
+inline const arrayAllocator * explicitHugePageArrayAllocator(){
+    static const arrayAllocator a = {&allocators::explicitHuge, &allocators::explicitHugeFree};
+    return &a;
+}
+
+namespace allocators{
+inline const arrayAllocator * fromEnvironment(){
+    const char * env = getenv("DJC_HUGEPAGES");
+    std::string mode = env ? env : "";
+    if(mode == "transparent")
+        return transparentHugePageArrayAllocator();
+    if(mode == "explicit")
+        return explicitHugePageArrayAllocator();
+    return alignedArrayAllocator();
+}
+inline const arrayAllocator *& current(){
+    static const arrayAllocator * a = fromEnvironment();
+    return a;
+}
+}//allocators
+
+/*
+ * allocator used for all new simpleArray data
+ */
+inline const arrayAllocator * currentArrayAllocator(){
+    return allocators::current();
+}
+
+/*
+ * set 0 to go back to the default
+ */
+inline void setArrayAllocator(const arrayAllocator * a){
+    if(!a)
+        a = allocators::fromEnvironment();
+    allocators::current() = a;
+}
+
+}//namespace
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ARRAYALLOCATOR_H_ */
@@ -14,9 +14,12 @@
 #include "TString.h"
 #include "TObject.h"
 #include "TString.h"
+#include "RtypesCore.h"
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 TString prependXRootD(const TString& path);
 
@@ -24,8 +27,43 @@ bool isApprox(const float& a , const float& b, float eps=0.001);
 
 float deltaPhi(const float& phi1, const float& phi2);
 
+/*
+ * maps an angle difference to [-pi, pi) without loops
+ */
+inline float wrapDeltaPhi(float delta){
+    const float pi = 3.14159265358979323846;
+    delta -= 2*pi * std::floor((delta + pi) / (2*pi));
+    //rounding at the edges
+    if(delta >= pi) delta -= 2*pi;
+    if(delta < -pi) delta += 2*pi;
+    return delta;
+}
+
 void checkTObject(const TObject * o, TString msg);
 
+class TFile;
+class TTree;
+/*
+ * Read options shared by all ROOT readers of the modules: the needed
+ * branches are read through a TTreeCache of cachesize bytes (-1: ROOT
+ * default, 0: no cache). With prefetch, ROOT reads the cached baskets
+ * asynchronously ahead, which helps most for remote (xrootd, EOS) files.
+ * Prefetching applies to files opened afterwards
+ */
+void setTreeReadOptions(Long64_t cachesize, bool prefetch);
+
+/*
+ * opens a file for reading, also remote ones. Throws if that fails.
+ * The caller owns the file
+ */
+TFile * openForReading(const TString& filename);
+
+/*
+ * enables only the given branches and registers them with the cache.
+ * Without branches, all stay enabled and the cache learns which are read
+ */
+void setupTreeCache(TTree * tree, const std::vector<TString>& branches=std::vector<TString>());
+
 template<class T>
 T*  getLineDouble(const T * h);
 
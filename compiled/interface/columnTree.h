@@ -0,0 +1,47 @@
+/*
+ * columnTree.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_COLUMNTREE_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_COLUMNTREE_H_
+
+#include <boost/python.hpp>
+#include "boost/python/numpy.hpp"
+#include "TString.h"
+#include "TTree.h"
+#include <vector>
+
+/*
+ * Memory-resident TTree built from columns, e.g. predictions and truths
+ * passed from numpy. The evaluation tools can then use their expression
+ * and cut syntax without ROOT friend trees on disk.
+ * A column with m>1 values per entry becomes a fixed-size array branch
+ * name[m], to be used as name[i] in expressions.
+ */
+class columnTree{
+public:
+    columnTree();
+    ~columnTree();
+
+    void addColumn(const TString& name, const float* data, size_t nentries, size_t m=1);
+
+    /* float32 arrays of shape (n) or (n,m), for all keys of a python dict */
+    void addColumns(const boost::python::dict& columns);
+
+    /* builds the tree on the first call, the column copies are released */
+    TTree* tree();
+
+private:
+    columnTree(const columnTree&)=delete;
+    columnTree& operator=(const columnTree&)=delete;
+
+    std::vector<TString> names_;
+    std::vector<size_t> widths_;
+    std::vector<std::vector<float> > data_;
+    size_t nentries_;
+    TTree* tree_;
+};
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_COLUMNTREE_H_ */
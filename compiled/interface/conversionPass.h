@@ -0,0 +1,970 @@
+/*
+ * conversionPass.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DEEPJET_MODULES_INTERFACE_CONVERSIONPASS_H_
+#define DEEPJET_MODULES_INTERFACE_CONVERSIONPASS_H_
+
+#include "indata.h"
+#include "normZeroPad.h"
+#include "helper.h"
+#include "c_helper.h"
+#include "simpleArray.h"
+#include "runningStats.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <limits>
+#include <cmath>
+
+namespace __hidden{
+
+inline int square_bins(
+        double xval, double xcenter,
+        int nbins, double half_width,
+        bool isPhi=false) {
+    double bin_width = (2*half_width)/nbins;
+    double low_edge = 0;
+    if(isPhi)
+        low_edge =deltaPhi( xcenter, half_width);
+    else
+        low_edge = xcenter - half_width;
+    int ibin = 0;
+    if(isPhi)
+        ibin=std::floor((double)deltaPhi(xval,low_edge)/bin_width);
+    else
+        ibin=std::floor((xval - low_edge)/bin_width);
+    return (ibin >= 0 && ibin < nbins) ? ibin : -1;
+}
+/*
+ * square_bins for n values at once, without branches in the loop
+ */
+inline void square_bins(const float * xvals, size_t n, int * bins,
+        double xcenter, int nbins, double half_width,
+        bool isPhi=false) {
+    const double bin_width = (2*half_width)/nbins;
+    if(isPhi){
+        const float low_edge = deltaPhi(xcenter, half_width);
+        for(size_t i=0;i<n;i++){
+            double ibin = std::floor((double)wrapDeltaPhi(xvals[i]-low_edge)/bin_width);
+            bins[i] = (ibin >= 0 && ibin < nbins) ? (int)ibin : -1;
+        }
+    }
+    else{
+        const double low_edge = xcenter - half_width;
+        for(size_t i=0;i<n;i++){
+            double ibin = std::floor((xvals[i] - low_edge)/bin_width);
+            bins[i] = (ibin >= 0 && ibin < nbins) ? (int)ibin : -1;
+        }
+    }
+}
+inline bool branchIsPhi(std::string branchname){
+    TString bn=branchname;
+    bn.ToLower();
+    return bn.Contains("phi");
+}
+
+/*
+ * All branches needed in one pass over a tree.
+ * Each branch is set up and read only once, however many outputs use it.
+ */
+class branchCollection{
+public:
+    /*
+     * returns the index of the branch, adds it if not there yet
+     */
+    size_t add(const TString& name);
+
+    void setup(TTree* tree, const TString& treename);
+
+    const std::vector<TString>& names()const{
+        return names_;
+    }
+
+    void readRange(Long64_t first, Long64_t last){
+        data_.readRange(first, last);
+    }
+    size_t size(size_t idx, Long64_t entry)const{
+        return data_.columnSize(idx, entry);
+    }
+    const float * data(size_t idx, Long64_t entry)const{
+        return data_.columnData(idx, entry);
+    }
+    bool isVector(size_t idx)const{
+        return data_.buffervec.at(idx);
+    }
+    /*
+     * element i scaled like indata::getData, padded like after indata::allZero
+     */
+    float value(size_t idx, Long64_t entry, size_t i, float mean=0, float norm=1)const{
+        if(i < size(idx, entry)){
+            float v = data(idx, entry)[i];
+            if(indata::doscaling)
+                v = (v - mean) / norm;
+            return v;
+        }
+        return indata::paddingValue(isVector(idx), mean, norm);
+    }
+    /*
+     * value(idx, entry, i, mean, norm) for i < n
+     */
+    void values(size_t idx, Long64_t entry, size_t n, float * out, float mean=0, float norm=1)const{
+        const size_t nreal = std::min(n, size(idx, entry));
+        normZeroPad(data(idx, entry), nreal, indata::doscaling ? mean : 0, indata::doscaling ? norm : 1,
+                indata::paddingValue(isVector(idx), mean, norm), out, n);
+    }
+
+private:
+    std::vector<TString> names_;
+    indata data_;
+};
+
+/*
+ * Scratch space of the image outputs, allocated once per range of entries
+ * and reused for each entry
+ */
+struct imageScratch{
+    std::vector<float> xvals, yvals;//candidate coordinates
+    std::vector<int> xidx, yidx;//their bins, -1 outside
+    std::vector<float> grid;//contiguous image of one entry
+    std::vector<double> sums;
+    std::vector<int> counts;
+
+    /*
+     * bins of the first n candidates of an entry
+     */
+    void binCandidates(const branchCollection& bc, Long64_t entry, size_t n,
+            size_t xbranch, float xcentre, int xbins, float xwidth, bool xisphi,
+            size_t ybranch, float ycentre, int ybins, float ywidth, bool yisphi){
+        xvals.resize(n);
+        yvals.resize(n);
+        xidx.resize(n);
+        yidx.resize(n);
+        bc.values(xbranch, entry, n, xvals.data());
+        bc.values(ybranch, entry, n, yvals.data());
+        square_bins(xvals.data(), n, xidx.data(), xcentre, xbins, xwidth, xisphi);
+        square_bins(yvals.data(), n, yidx.data(), ycentre, ybins, ywidth, yisphi);
+    }
+};
+
+/*
+ * One output array filled in a conversion pass.
+ * fill is called from several threads for different entries at the same time.
+ */
+class convOutput{
+public:
+    virtual ~convOutput(){}
+    virtual void addBranches(branchCollection& bc)=0;
+    virtual void fill(const branchCollection& bc, Long64_t entry)=0;
+    //called for consecutive entries of one cluster
+    virtual void fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+        for(Long64_t entry=first;entry<last;entry++)
+            fill(bc, entry);
+    }
+    //entries that fit
+    virtual size_t nRows()const=0;
+};
+
+/*
+ * process (flat) and particlecluster (particle-wise)
+ */
+class meanNormZeroPadOutput: public convOutput{
+public:
+    enum modeen {en_flat,en_particlewise};
+
+    meanNormZeroPadOutput(const numpyView<float>& out, modeen mode,
+            const std::vector< std::vector<TString> >& branches,
+            const std::vector< std::vector<double> >& norms,
+            const std::vector< std::vector<double> >& means,
+            const std::vector<int>& maxs);
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry);
+    size_t nRows()const{return out_.shape(0);}
+
+private:
+    struct branchConfig{
+        TString name;
+        size_t idx;
+        float mean, norm;
+        size_t max, offset;
+    };
+    numpyView<float> out_;
+    modeen mode_;
+    std::vector<branchConfig> branches_;
+};
+
+class particleBinnerOutput: public convOutput{
+public:
+    particleBinnerOutput(const numpyView<float>& out, const numpyView<float>& sum_out,
+            std::string counter_branch,
+            std::string xbranch, std::string xcenter, int xbins, float xwidth,
+            std::string ybranch, std::string ycenter, int ybins, float ywidth,
+            const std::vector<TString>& branches, const std::vector<double>& norms,
+            const std::vector<double>& means, int nmax,
+            const std::vector<TString>& sum_branches, const std::vector<double>& sum_norms,
+            const std::vector<double>& sum_means);
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry){
+        fillRange(bc, entry, entry+1);
+    }
+    void fillRange(const branchCollection& bc, Long64_t first, Long64_t last);
+    size_t nRows()const{return out_.shape(0);}
+
+private:
+    void fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s,
+            const std::vector<float>& padding);
+
+    numpyView<float> out_, sum_out_;
+    std::vector<TString> names_;//counter, x, y, xcenter, ycenter
+    std::vector<size_t> idxs_;
+    int xbins_, ybins_;
+    float xwidth_, ywidth_;
+    bool xisphi_, yisphi_;
+    std::vector<TString> branches_, sum_branches_;
+    std::vector<size_t> bidxs_, sum_bidxs_;
+    std::vector<float> norms_, means_, sum_norms_, sum_means_;
+    int nmax_;
+};
+
+/*
+ * fillDensityMap and fillCountMap (no branch)
+ */
+class densityMapOutput: public convOutput{
+public:
+    densityMapOutput(const numpyView<float>& out, double norm,
+            std::string branch, std::string weightbranch, std::string counter_branch,
+            std::string xbranch, std::string xcenter, int xbins, float xwidth,
+            std::string ybranch, std::string ycenter, int ybins, float ywidth,
+            double offset);
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry){
+        fillRange(bc, entry, entry+1);
+    }
+    void fillRange(const branchCollection& bc, Long64_t first, Long64_t last);
+    size_t nRows()const{return out_.shape(0);}
+
+private:
+    void fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s);
+
+    numpyView<float> out_;
+    float norm_, offset_;
+    std::vector<TString> names_;//counter, x, y, xcenter, ycenter, branch, weight
+    std::vector<size_t> idxs_;
+    int xbins_, ybins_;
+    float xwidth_, ywidth_;
+    bool xisphi_, yisphi_;
+    bool count_, useweights_;
+};
+
+class densityLayersOutput: public convOutput{
+public:
+    densityLayersOutput(const numpyView<float>& out,
+            const std::vector<TString>& branches, const std::vector<double>& norms,
+            const std::vector<double>& means, const std::vector<TString>& modes,
+            std::string layer_branch, int maxlayers, int layer_offset,
+            std::string counter_branch,
+            std::string xbranch, std::string xcenter, int xbins, float xwidth,
+            std::string ybranch, std::string ycenter, int ybins, float ywidth);
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry){
+        fillRange(bc, entry, entry+1);
+    }
+    void fillRange(const branchCollection& bc, Long64_t first, Long64_t last);
+    size_t nRows()const{return out_.shape(0);}
+
+private:
+    void fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s);
+
+    enum en_fillmodes{fm_sum,fm_average,fm_single, fm_relXsingle,fm_relYsingle};
+    numpyView<float> out_;
+    std::vector<TString> names_;//counter, x, y, xcenter, ycenter, layer
+    std::vector<size_t> idxs_;
+    int xbins_, ybins_;
+    float xwidth_, ywidth_;
+    bool xisphi_, yisphi_;
+    std::vector<TString> branches_;
+    std::vector<size_t> bidxs_;
+    std::vector<float> norms_, means_;
+    std::vector<en_fillmodes> fillmodes_;
+    int maskedlayerbranch_;
+    bool uselayers_;
+    int maxlayers_, layer_offset_;
+};
+
+/*
+ * particlecluster without padding: one row per particle, with row splits
+ * per entry, result shape [entries, -particles, features].
+ * Only real entries are normalised. The number of particles of an entry is
+ * the length of its longest branch, cut at max if max > 0.
+ */
+class raggedOutput: public convOutput{
+public:
+    raggedOutput(const std::vector<TString>& branches, const std::vector<double>& norms,
+            const std::vector<double>& means, int max, Long64_t maxentries=-1);
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry){
+        fillRange(bc, entry, entry+1);
+    }
+    void fillRange(const branchCollection& bc, Long64_t first, Long64_t last);
+    size_t nRows()const;
+
+    /*
+     * moves everything filled so far into one array
+     */
+    djc::simpleArray<float> result();
+
+private:
+    struct chunk{
+        std::vector<int64_t> nparticles;
+        std::vector<float> values;
+    };
+    std::vector<TString> branches_;
+    std::vector<size_t> bidxs_;
+    std::vector<float> norms_, means_;
+    int max_;
+    Long64_t maxentries_;
+    std::map<Long64_t, chunk> chunks_;//by first entry
+    std::mutex mutex_;
+};
+
+/*
+ * No array, accumulates the statistics of the unscaled values for the
+ * means and norms. Each range is accumulated on its own and merged into
+ * stats, which can be shared by passes over several files.
+ * Scalar branches are treated as in preprocessing.meanNormProd (-999 is 0).
+ */
+class statisticsOutput: public convOutput{
+public:
+    statisticsOutput(std::shared_ptr<branchStatistics> stats, Long64_t maxentries=-1):
+        stats_(stats),bidxs_(stats->size(), 0),maxentries_(maxentries){}
+
+    void addBranches(branchCollection& bc);
+    void fill(const branchCollection& bc, Long64_t entry){
+        fillRange(bc, entry, entry+1);
+    }
+    void fillRange(const branchCollection& bc, Long64_t first, Long64_t last);
+    size_t nRows()const;
+
+private:
+    std::shared_ptr<branchStatistics> stats_;
+    std::vector<size_t> bidxs_;
+    Long64_t maxentries_;
+    std::mutex mutex_;
+};
+
+/*
+ * Fills all outputs in one loop over the tree, reading cluster by cluster.
+ * With nthreads > 1 the entries are split in ranges, each converted with
+ * its own file handle. Does not need the GIL.
+ */
+inline void fillOutputs(const std::vector<std::shared_ptr<convOutput> >& outputs,
+        const TString& filename, const TString& treename, size_t nthreads);
+
+///implementation
+
+inline size_t branchCollection::add(const TString& name){
+    for(size_t i=0;i<names_.size();i++)
+        if(names_.at(i) == name)
+            return i;
+    names_.push_back(name);
+    return names_.size()-1;
+}
+
+inline void branchCollection::setup(TTree* tree, const TString& treename){
+    //scaling is done by the outputs
+    data_.createFrom(names_, std::vector<double>(names_.size(), 1.),
+            std::vector<double>(names_.size(), 0.), 1);
+    data_.setup(tree, treename);
+}
+
+inline meanNormZeroPadOutput::meanNormZeroPadOutput(const numpyView<float>& out, modeen mode,
+        const std::vector< std::vector<TString> >& branches,
+        const std::vector< std::vector<double> >& norms,
+        const std::vector< std::vector<double> >& means,
+        const std::vector<int>& maxs):out_(out),mode_(mode){
+    if(branches.size() != norms.size() || branches.size() != means.size() || branches.size() != maxs.size())
+        throw std::runtime_error("meanNormZeroPadOutput: inputs must have same size");
+    if(mode == en_particlewise && branches.size() > 1)
+        throw std::runtime_error("particlecluster only possible for one collection of same type at a time");
+
+    size_t offset=0;
+    for(size_t c=0;c<branches.size();c++){
+        if(branches.at(c).size() != norms.at(c).size() || norms.at(c).size() != means.at(c).size())
+            throw std::runtime_error("meanNormZeroPadOutput: inputs must have same size");
+        for(size_t b=0;b<branches.at(c).size();b++){
+            branchConfig bc = {branches.at(c).at(b), 0, (float)means.at(c).at(b), (float)norms.at(c).at(b),
+                    (size_t)maxs.at(c), offset};
+            if(mode == en_particlewise)
+                bc.offset = b;
+            branches_.push_back(bc);
+            offset += maxs.at(c);
+        }
+    }
+    if(mode == en_flat){
+        out_.checkShape(1, offset, "meanNormZeroPadOutput");
+    }
+    else if(branches.size()){
+        out_.checkShape(1, maxs.at(0), "meanNormZeroPadOutput");
+        out_.checkShape(2, branches.at(0).size(), "meanNormZeroPadOutput");
+    }
+}
+
+inline void meanNormZeroPadOutput::addBranches(branchCollection& bc){
+    for(auto& b: branches_)
+        b.idx = bc.add(b.name);
+}
+
+inline void meanNormZeroPadOutput::fill(const branchCollection& bc, Long64_t entry){
+    for(const auto& b: branches_){
+        float mean = 0, norm = 1;
+        if(indata::doscaling){
+            mean = b.mean;
+            norm = b.norm;
+        }
+        float * dst = mode_ == en_flat ? &out_(entry, b.offset) : &out_(entry, 0, b.offset);
+        normZeroPad(bc.data(b.idx, entry), bc.size(b.idx, entry), mean, norm,
+                indata::paddingValue(bc.isVector(b.idx), b.mean, b.norm),
+                dst, b.max, out_.stride(1));
+    }
+}
+
+inline particleBinnerOutput::particleBinnerOutput(const numpyView<float>& out, const numpyView<float>& sum_out,
+        std::string counter_branch,
+        std::string xbranch, std::string xcenter, int xbins, float xwidth,
+        std::string ybranch, std::string ycenter, int ybins, float ywidth,
+        const std::vector<TString>& branches, const std::vector<double>& norms,
+        const std::vector<double>& means, int nmax,
+        const std::vector<TString>& sum_branches, const std::vector<double>& sum_norms,
+        const std::vector<double>& sum_means):
+        out_(out), sum_out_(sum_out),
+        names_({counter_branch, xbranch, ybranch, xcenter, ycenter}),
+        idxs_(names_.size(), 0),
+        xbins_(xbins), ybins_(ybins), xwidth_(xwidth), ywidth_(ywidth),
+        xisphi_(branchIsPhi(xbranch)), yisphi_(branchIsPhi(ybranch)),
+        branches_(branches), sum_branches_(sum_branches),
+        bidxs_(branches.size(), 0), sum_bidxs_(sum_branches.size(), 0),
+        norms_(norms.begin(), norms.end()), means_(means.begin(), means.end()),
+        sum_norms_(sum_norms.begin(), sum_norms.end()), sum_means_(sum_means.begin(), sum_means.end()),
+        nmax_(nmax){
+    if(branches.size() != norms.size() || branches.size() != means.size())
+        throw std::runtime_error("particle_binner: inputs must have same size");
+    if(sum_norms.size() < sum_branches.size()+1 || sum_means.size() < sum_branches.size()+1)
+        throw std::runtime_error("particle_binner: summed means and norms need one more entry for the counts");
+    out_.checkShape(1, xbins, "particle_binner");
+    out_.checkShape(2, ybins, "particle_binner");
+    out_.checkShape(3, nmax, "particle_binner");
+    out_.checkShape(4, branches.size(), "particle_binner");
+    sum_out_.checkShape(0, out_.shape(0), "particle_binner");
+    sum_out_.checkShape(1, xbins, "particle_binner");
+    sum_out_.checkShape(2, ybins, "particle_binner");
+    sum_out_.checkShape(3, sum_branches.size()+1, "particle_binner");
+}
+
+inline void particleBinnerOutput::addBranches(branchCollection& bc){
+    for(size_t i=0;i<names_.size();i++)
+        idxs_.at(i) = bc.add(names_.at(i));
+    for(size_t i=0;i<branches_.size();i++)
+        bidxs_.at(i) = bc.add(branches_.at(i));
+    for(size_t i=0;i<sum_branches_.size();i++)
+        sum_bidxs_.at(i) = bc.add(sum_branches_.at(i));
+}
+
+inline void particleBinnerOutput::fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+    imageScratch s;
+    s.grid.resize(xbins_*ybins_*nmax_*branches_.size());
+    s.sums.resize(xbins_*ybins_*(sum_branches_.size()+1));
+    s.counts.resize(xbins_*ybins_);
+    std::vector<float> padding(branches_.size());
+    for(size_t ifeat=0; ifeat<padding.size(); ifeat++)
+        padding[ifeat] = indata::paddingValue(false, means_.at(ifeat), norms_.at(ifeat));
+    for(Long64_t jet=first;jet<last;jet++)
+        fillEntry(bc, jet, s, padding);
+}
+
+inline void particleBinnerOutput::fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s,
+        const std::vector<float>& padding){
+    const size_t nsum = sum_branches_.size()+1;
+    const size_t nfeat = branches_.size();
+    //grid as [x][y][particle][feature], summed features as [x][y][feature]
+    const size_t cellsize = nmax_*nfeat;
+
+    //pad with defaults every bin
+    for(size_t i=0; i<s.grid.size(); i+=nfeat)
+        std::copy(padding.begin(), padding.end(), s.grid.begin()+i);
+    std::fill(s.sums.begin(), s.sums.end(), 0);
+    std::fill(s.counts.begin(), s.counts.end(), 0);
+
+    //bin all candidates at once
+    const float xcentre = bc.value(idxs_[3], jet, 0);
+    const float ycentre = bc.value(idxs_[4], jet, 0);
+    const int ncharged = std::max(0, (int)bc.value(idxs_[0], jet, 0));
+    s.binCandidates(bc, jet, ncharged,
+            idxs_[1], xcentre, xbins_, xwidth_, xisphi_,
+            idxs_[2], ycentre, ybins_, ywidth_, yisphi_);
+
+    for(int elem=0; elem < ncharged; elem++) {
+        const int xidx = s.xidx[elem], yidx = s.yidx[elem];
+        if(xidx == -1 || yidx == -1) continue;
+        const size_t cell = xidx*ybins_+yidx;
+
+        //bin summing
+        double * summed = &s.sums[cell*nsum];
+        summed[0]++;
+        for(size_t ifeat=1; ifeat < nsum; ifeat++) {
+            const size_t sidx = sum_bidxs_[ifeat-1];
+            if((size_t)elem < bc.size(sidx, jet))
+                summed[ifeat] += bc.data(sidx, jet)[elem];
+        }
+
+        //single values
+        //if bin is full skip
+        int& filled = s.counts[cell];
+        if(filled == nmax_) continue;
+        float * particle = &s.grid[cell*cellsize + filled*nfeat];
+        filled++;
+
+        for(size_t ifeat=0; ifeat<nfeat; ifeat++) {
+            particle[ifeat] = bc.value(bidxs_[ifeat], jet, elem, means_[ifeat], norms_[ifeat]);
+        }
+    }
+
+    //write cell by cell
+    const size_t pstride = out_.stride(3), fstride = out_.stride(4);
+    const size_t sstride = sum_out_.stride(3);
+    for(int x=0; x<xbins_; x++) {
+        for(int y=0; y<ybins_; y++) {
+            const size_t cell = x*ybins_+y;
+            const float * src = &s.grid[cell*cellsize];
+            float * dst = &out_(jet,x,y,0,0);
+            for(int idx=0; idx<nmax_; idx++)
+                for(size_t ifeat=0; ifeat<nfeat; ifeat++)
+                    dst[idx*pstride + ifeat*fstride] = src[idx*nfeat + ifeat];
+
+            const double * summed = &s.sums[cell*nsum];
+            float * sumdst = &sum_out_(jet,x,y,0);
+            for(size_t ifeat=0; ifeat < nsum; ifeat++) {
+                //hardcoded scaling! to change if zero padding method changes!
+                sumdst[ifeat*sstride] = (summed[ifeat] - sum_means_[ifeat]) / sum_norms_[ifeat];
+            }
+        }
+    }
+}
+
+inline densityMapOutput::densityMapOutput(const numpyView<float>& out, double norm,
+        std::string branch, std::string weightbranch, std::string counter_branch,
+        std::string xbranch, std::string xcenter, int xbins, float xwidth,
+        std::string ybranch, std::string ycenter, int ybins, float ywidth,
+        double offset):
+        out_(out), norm_(norm), offset_(offset),
+        names_({counter_branch, xbranch, ybranch, xcenter, ycenter, branch, weightbranch}),
+        idxs_(names_.size(), 0),
+        xbins_(xbins), ybins_(ybins), xwidth_(xwidth), ywidth_(ywidth),
+        xisphi_(branchIsPhi(xbranch)), yisphi_(branchIsPhi(ybranch)),
+        count_(!branch.length()), useweights_(weightbranch.length()){
+    out_.checkShape(1, xbins, "fillDensityMap");
+    out_.checkShape(2, ybins, "fillDensityMap");
+    out_.checkShape(3, 1, "fillDensityMap");
+}
+
+inline void densityMapOutput::addBranches(branchCollection& bc){
+    for(size_t i=0;i<names_.size();i++){
+        if((i==5 && count_) || (i==6 && !useweights_))
+            continue;
+        idxs_.at(i) = bc.add(names_.at(i));
+    }
+}
+
+inline void densityMapOutput::fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+    imageScratch s;
+    s.grid.resize(xbins_*ybins_);
+    for(Long64_t jet=first;jet<last;jet++)
+        fillEntry(bc, jet, s);
+}
+
+inline void densityMapOutput::fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s){
+    std::fill(s.grid.begin(), s.grid.end(), 0);
+
+    const float xcentre = bc.value(idxs_[3], jet, 0);
+    const float ycentre = bc.value(idxs_[4], jet, 0);
+    const int ncharged = std::max(0, (int)bc.value(idxs_[0], jet, 0));
+    s.binCandidates(bc, jet, ncharged,
+            idxs_[1], xcentre, xbins_, xwidth_, xisphi_,
+            idxs_[2], ycentre, ybins_, ywidth_, yisphi_);
+
+    for(int elem=0; elem < ncharged; elem++) {
+        const int xidx = s.xidx[elem], yidx = s.yidx[elem];
+        if(xidx == -1 || yidx == -1) continue;
+        float feature_value = 1;
+        if(!count_)//only normalisation, no mean subtraction
+            feature_value = bc.value(idxs_[5], jet, elem, 0, norm_)-offset_;
+        float weight_value =1;
+        if(useweights_)
+            weight_value = bc.value(idxs_[6], jet, elem);
+
+        s.grid[xidx*ybins_+yidx]+=feature_value*weight_value;
+    }
+
+    const size_t ystride = out_.stride(2);
+    for(int i=0;i<xbins_;i++){
+        float * dst = &out_(jet,i,0,0);
+        for(int j=0;j<ybins_;j++)
+            dst[j*ystride]=s.grid[i*ybins_+j];
+    }
+}
+
+inline densityLayersOutput::densityLayersOutput(const numpyView<float>& out,
+        const std::vector<TString>& branches, const std::vector<double>& norms,
+        const std::vector<double>& means, const std::vector<TString>& modes,
+        std::string layer_branch, int maxlayers, int layer_offset,
+        std::string counter_branch,
+        std::string xbranch, std::string xcenter, int xbins, float xwidth,
+        std::string ybranch, std::string ycenter, int ybins, float ywidth):
+        out_(out),
+        names_({counter_branch, xbranch, ybranch, xcenter, ycenter, layer_branch}),
+        idxs_(names_.size(), 0),
+        xbins_(xbins), ybins_(ybins), xwidth_(xwidth), ywidth_(ywidth),
+        xisphi_(branchIsPhi(xbranch)), yisphi_(branchIsPhi(ybranch)),
+        branches_(branches), bidxs_(branches.size(), 0),
+        norms_(norms.begin(), norms.end()), means_(means.begin(), means.end()),
+        fillmodes_(modes.size()),
+        maskedlayerbranch_(-1), uselayers_(layer_branch.length()),
+        maxlayers_(maxlayers), layer_offset_(layer_offset){
+
+    if(branches.size() != norms.size() || branches.size() != means.size() || branches.size() != modes.size())
+        throw std::runtime_error("fillDensityLayers: inputs must have same size");
+    for(size_t i=0;i<fillmodes_.size();i++){
+        const TString& mode=modes.at(i);
+        if(mode=="sum")
+            fillmodes_.at(i)=fm_sum;
+        else if(mode=="average")
+            fillmodes_.at(i)=fm_average;
+        else if(mode=="single")
+            fillmodes_.at(i)=fm_single;
+        else if(mode=="relXsingle")
+            fillmodes_.at(i)=fm_relXsingle;
+        else if(mode=="relYsingle")
+            fillmodes_.at(i)=fm_relYsingle;
+        else
+            throw std::runtime_error("fillDensityLayers: fill mode not recognised");
+    }
+    //in case the layer branch has also been used as a feature branch, the layer index is used
+    for(size_t i=0;i<branches.size();i++){
+        if(branches.at(i) == (TString)layer_branch){
+            maskedlayerbranch_=i;
+            break;
+        }
+    }
+    if(!uselayers_)
+        maxlayers_=1;
+
+    out_.checkShape(1, xbins, "fillDensityLayers");
+    out_.checkShape(2, ybins, "fillDensityLayers");
+    out_.checkShape(3, maxlayers_, "fillDensityLayers");
+    out_.checkShape(4, branches.size(), "fillDensityLayers");
+}
+
+inline void densityLayersOutput::addBranches(branchCollection& bc){
+    for(size_t i=0;i<names_.size();i++){
+        if(i==5 && !uselayers_)
+            continue;
+        idxs_.at(i) = bc.add(names_.at(i));
+    }
+    for(size_t i=0;i<branches_.size();i++){
+        if((int)i != maskedlayerbranch_)
+            bidxs_.at(i) = bc.add(branches_.at(i));
+    }
+}
+
+inline void densityLayersOutput::fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+    imageScratch s;
+    s.grid.resize(xbins_*ybins_*maxlayers_*branches_.size());
+    s.counts.resize(xbins_*ybins_*maxlayers_);
+    for(Long64_t jet=first;jet<last;jet++)
+        fillEntry(bc, jet, s);
+}
+
+inline void densityLayersOutput::fillEntry(const branchCollection& bc, Long64_t jet, imageScratch& s){
+    const size_t nfeat = branches_.size();
+    //grid as [x][y][layer][feature], starts from what is in the array
+    const size_t cellsize = maxlayers_*nfeat;
+    const size_t lstride = out_.stride(3), fstride = out_.stride(4);
+    for(int i=0;i<xbins_;i++){
+        for(int j=0;j<ybins_;j++){
+            const float * src = &out_(jet,i,j,0,0);
+            float * dst = &s.grid[(i*ybins_+j)*cellsize];
+            for(int l=0;l<maxlayers_;l++)
+                for(size_t i_feat=0;i_feat<nfeat;i_feat++)
+                    dst[l*nfeat+i_feat] = src[l*lstride+i_feat*fstride];
+        }
+    }
+    std::fill(s.counts.begin(), s.counts.end(), 0);
+
+    const float xcentre = bc.value(idxs_[3], jet, 0);
+    const float ycentre = bc.value(idxs_[4], jet, 0);
+    const int ncharged = std::max(0, (int)bc.value(idxs_[0], jet, 0));
+    s.binCandidates(bc, jet, ncharged,
+            idxs_[1], xcentre, xbins_, xwidth_, xisphi_,
+            idxs_[2], ycentre, ybins_, ywidth_, yisphi_);
+
+    for(int elem=0; elem < ncharged; elem++) {
+        const int xidx = s.xidx[elem], yidx = s.yidx[elem];
+        if(xidx == -1 || yidx == -1) continue;
+
+        int layer=0;
+        if(uselayers_)
+            layer=round(bc.value(idxs_[5], jet, elem))-layer_offset_;
+
+        if(layer>=maxlayers_)
+            layer=maxlayers_-1;
+        if(layer<0)
+            layer=0;
+        float * pixel = &s.grid[((xidx*ybins_+yidx)*maxlayers_+layer)*nfeat];
+        for(size_t i_feat=0;i_feat<nfeat;i_feat++){
+
+            float featval=0;
+            if(maskedlayerbranch_>=0 && (size_t)maskedlayerbranch_==i_feat)
+                featval=(float)layer/norms_.at(i_feat);
+            else
+                featval=bc.value(bidxs_[i_feat], jet, elem, means_[i_feat], norms_[i_feat]);
+
+            if(fillmodes_[i_feat] == fm_single)
+                pixel[i_feat]=featval;
+            else if(fillmodes_[i_feat] == fm_relXsingle)
+                pixel[i_feat]=featval-xcentre;
+            else if(fillmodes_[i_feat] == fm_relYsingle)
+                pixel[i_feat]=featval-ycentre;
+            else //(fillmodes_[i_feat]==fm_sum || fillmodes_[i_feat]==fm_average)
+                pixel[i_feat]+=featval;
+        }
+
+        s.counts[(xidx*ybins_+yidx)*maxlayers_+layer]++;
+    }
+
+    //average and write back
+    for(int i=0;i<xbins_;i++){
+        for(int j=0;j<ybins_;j++){
+            const float * src = &s.grid[(i*ybins_+j)*cellsize];
+            const int * counts = &s.counts[(i*ybins_+j)*maxlayers_];
+            float * dst = &out_(jet,i,j,0,0);
+            for(int l=0;l<maxlayers_;l++){
+                for(size_t i_feat=0;i_feat<nfeat;i_feat++){
+                    float v = src[l*nfeat+i_feat];
+                    if(fillmodes_[i_feat]==fm_average && counts[l])
+                        v /= (float)counts[l];
+                    dst[l*lstride+i_feat*fstride] = v;
+                }
+            }
+        }
+    }
+}
+
+inline raggedOutput::raggedOutput(const std::vector<TString>& branches, const std::vector<double>& norms,
+        const std::vector<double>& means, int max, Long64_t maxentries):
+        branches_(branches), bidxs_(branches.size(), 0),
+        norms_(norms.begin(), norms.end()), means_(means.begin(), means.end()),
+        max_(max), maxentries_(maxentries){
+    if(branches.size() != norms.size() || branches.size() != means.size())
+        throw std::runtime_error("raggedOutput: inputs must have same size");
+}
+
+inline void raggedOutput::addBranches(branchCollection& bc){
+    for(size_t i=0;i<branches_.size();i++)
+        bidxs_.at(i) = bc.add(branches_.at(i));
+}
+
+inline size_t raggedOutput::nRows()const{
+    if(maxentries_ < 0)
+        return std::numeric_limits<Long64_t>::max();
+    return maxentries_;
+}
+
+inline void raggedOutput::fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+    const size_t nfeat = branches_.size();
+    chunk c;
+    c.nparticles.reserve(last-first);
+    for(Long64_t entry=first;entry<last;entry++){
+        size_t n = 0;
+        for(size_t b=0;b<nfeat;b++)
+            n = std::max(n, bc.size(bidxs_[b], entry));
+        if(max_ > 0 && n > (size_t)max_)
+            n = max_;
+        c.nparticles.push_back(n);
+        const size_t start = c.values.size();
+        c.values.resize(start + n*nfeat);
+        for(size_t b=0;b<nfeat;b++){
+            float mean = 0, norm = 1;
+            if(indata::doscaling){
+                mean = means_[b];
+                norm = norms_[b];
+            }
+            normZeroPad(bc.data(bidxs_[b], entry), bc.size(bidxs_[b], entry), mean, norm,
+                    indata::paddingValue(bc.isVector(bidxs_[b]), means_[b], norms_[b]),
+                    c.values.data()+start+b, n, nfeat);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_[first] = std::move(c);
+}
+
+inline djc::simpleArray<float> raggedOutput::result(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int64_t> rowsplits(1, 0);
+    Long64_t next = 0;
+    for(const auto& c: chunks_){
+        if(c.first != next)
+            throw std::runtime_error("raggedOutput::result: entries missing");
+        for(const auto& n: c.second.nparticles)
+            rowsplits.push_back(rowsplits.back() + n);
+        next += c.second.nparticles.size();
+    }
+    djc::simpleArray<float> out({(int)rowsplits.size()-1, 0, (int)branches_.size()}, rowsplits);
+    float * dst = out.data();
+    for(auto& c: chunks_){
+        if(c.second.values.size())
+            memcpy(dst, &c.second.values[0], c.second.values.size()*sizeof(float));
+        dst += c.second.values.size();
+    }
+    chunks_.clear();
+    return out;
+}
+
+inline void statisticsOutput::addBranches(branchCollection& bc){
+    for(size_t i=0;i<stats_->size();i++)
+        bidxs_.at(i) = bc.add(stats_->name(i));
+}
+
+inline size_t statisticsOutput::nRows()const{
+    if(maxentries_ < 0)
+        return std::numeric_limits<Long64_t>::max();
+    return maxentries_;
+}
+
+inline void statisticsOutput::fillRange(const branchCollection& bc, Long64_t first, Long64_t last){
+    std::vector<std::string> names;
+    for(size_t b=0;b<stats_->size();b++)
+        names.push_back(stats_->name(b));
+    branchStatistics local(names, stats_->maxElements(), stats_->quantilePoints());
+    std::vector<float> scalars;
+    scalars.reserve(last-first);
+
+    for(size_t b=0;b<local.size();b++){
+        const size_t idx = bidxs_.at(b);
+        if(bc.isVector(idx)){
+            for(Long64_t entry=first;entry<last;entry++){
+                const float * data = bc.data(idx, entry);
+                const size_t n = bc.size(idx, entry);
+                local.total(b).add(data, n);
+                for(size_t i=0;i<n && i<local.maxElements();i++)
+                    local.element(b, i).add(data[i]);
+            }
+            continue;
+        }
+        scalars.clear();
+        for(Long64_t entry=first;entry<last;entry++){
+            if(!bc.size(idx, entry))
+                continue;
+            const float v = bc.data(idx, entry)[0];
+            scalars.push_back(v == -999 ? 0 : v);
+        }
+        local.total(b).add(scalars.data(), scalars.size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_->merge(local);
+}
+
+namespace _hidden{
+inline void fillOutputsRange(const std::vector<std::shared_ptr<convOutput> >& outputs,
+        branchCollection bc, TTree* tree, const TString& treename,
+        Long64_t firstentry, Long64_t lastentry){
+
+    setupTreeCache(tree, bc.names());
+    bc.setup(tree, treename);
+
+    //read cluster by cluster into columnar buffers, entries are contiguous there
+    auto clusters = tree->GetClusterIterator(firstentry);
+    Long64_t first=0;
+    while((first = clusters()) < lastentry){
+        first = std::max(first, firstentry);
+        const Long64_t last = std::min(clusters.GetNextEntry(), lastentry);
+        bc.readRange(first, last);
+        for(auto& o: outputs){
+            const Long64_t olast = std::min(last, (Long64_t)o->nRows());
+            if(olast > first)
+                o->fillRange(bc, first, olast);
+        }
+    }
+}
+}
+
+inline void fillOutputs(const std::vector<std::shared_ptr<convOutput> >& outputs,
+        const TString& filename, const TString& treename, size_t nthreads){
+
+    //below, a thread is not worth opening another file handle
+    const Long64_t minentriesperthread=1000;
+
+    branchCollection bc;
+    Long64_t nrows=0;
+    for(auto& o: outputs){
+        o->addBranches(bc);
+        nrows = std::max(nrows, (Long64_t)o->nRows());
+    }
+
+    std::unique_ptr<TFile> tfile(openForReading(filename));
+    TTree* tree=(TTree*)tfile->Get(treename);
+    if(!tree)
+        throw std::runtime_error("fillOutputs: tree \""+(std::string)treename +"\" not found");
+    const Long64_t nevents=std::min(tree->GetEntries(), nrows);
+
+    if((Long64_t)nthreads > nevents / minentriesperthread)
+        nthreads = nevents / minentriesperthread;
+    if(nthreads < 2){
+        _hidden::fillOutputsRange(outputs, bc, tree, treename, 0, nevents);
+        tfile->Close();
+        return;
+    }
+
+    //each thread has its own file handle and buffers and fills its own rows
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(nthreads);
+    for(size_t t=0;t<nthreads;t++){
+        Long64_t first = nevents * t / nthreads;
+        Long64_t last = nevents * (t+1) / nthreads;
+        threads.push_back(std::thread([&, t, first, last](){
+            try{
+                std::unique_ptr<TFile> tf(openForReading(filename));
+                TTree* ttree=(TTree*)tf->Get(treename);
+                if(!ttree)
+                    throw std::runtime_error("fillOutputs: tree \""+(std::string)treename +"\" not found");
+                _hidden::fillOutputsRange(outputs, bc, ttree, treename, first, last);
+                tf->Close();
+            }
+            catch(...){
+                errors.at(t) = std::current_exception();
+            }
+        }));
+    }
+    for(auto& t: threads)
+        t.join();
+    tfile->Close();
+    for(auto& e: errors)
+        if(e)
+            std::rethrow_exception(e);
+}
+
+}//__hidden
+
+#endif /* DEEPJET_MODULES_INTERFACE_CONVERSIONPASS_H_ */
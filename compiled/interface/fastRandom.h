@@ -0,0 +1,81 @@
+/*
+ * fastRandom.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_FASTRANDOM_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_FASTRANDOM_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace djc{
+
+/*
+ * xoshiro256** seeded through splitmix64. Small, fast and good enough
+ * for sampling; satisfies UniformRandomBitGenerator, so it can be used
+ * with std::shuffle and the std distributions.
+ * The stream argument gives independent sequences for the same seed,
+ * e.g. one per chunk of data, so results don't depend on the thread count.
+ */
+class fastRandom{
+public:
+    typedef uint64_t result_type;
+
+    explicit fastRandom(uint64_t seed=0, uint64_t stream=0){
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+        for(int i=0;i<4;i++)
+            s_[i]=splitmix64(x);
+    }
+
+    static constexpr result_type min(){return 0;}
+    static constexpr result_type max(){return std::numeric_limits<result_type>::max();}
+
+    result_type operator()(){
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    /* uniform in [0,1) with 53 bits */
+    double uniform(){
+        return (double)((*this)() >> 11) * (1.0/9007199254740992.0);//2^-53
+    }
+
+    /* uniform in [0,n) without modulo bias (Lemire) */
+    uint64_t below(uint64_t n){
+        unsigned __int128 m = (unsigned __int128)(*this)() * n;
+        uint64_t l = (uint64_t)m;
+        if(l < n){
+            const uint64_t t = -n % n;
+            while(l < t){
+                m = (unsigned __int128)(*this)() * n;
+                l = (uint64_t)m;
+            }
+        }
+        return (uint64_t)(m >> 64);
+    }
+
+private:
+    static uint64_t rotl(const uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+    static uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    uint64_t s_[4];
+};
+
+}//namespace
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_FASTRANDOM_H_ */
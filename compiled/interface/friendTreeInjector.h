@@ -10,11 +10,16 @@
 
 #include "TString.h"
 #include "TChain.h"
+#include <string>
+#include <unordered_map>
 
 class friendTreeInjector{
 public:
 	friendTreeInjector(const TString& sourcetreename);
-	friendTreeInjector(){}
+	friendTreeInjector():chain_(0){}
+	/* copies the file lists and entry counts, the copy creates its own chain */
+	friendTreeInjector(const friendTreeInjector& rhs);
+	friendTreeInjector& operator=(const friendTreeInjector& rhs);
 	~friendTreeInjector();
 
 	void setSourceTreeName(const TString& sourcetreename){
@@ -24,6 +29,18 @@ public:
 
 	void addFromFile(const TString& filename, const TString& alias="");
 
+	/*
+	 * entry counts of all trees are cached in this file, checked against
+	 * file size and modification time. Default: empty, no cache file
+	 */
+	void setManifest(const TString& manifest){
+		manifest_=manifest;
+	}
+
+	/*
+	 * counts the entries of all trees in parallel (or takes them from the
+	 * manifest) and checks them per file. All mismatches are reported at once
+	 */
 	void createChain();
 
 	TChain* getChain(){return chain_;}
@@ -34,9 +51,14 @@ public:
 private:
 
 	void resetChain();
+	void countEntries(const std::vector<std::pair<TString,TString> >& trees);
+	Long64_t entries(const TString& file, const TString& tree)const;
 
 	std::vector<std::vector<TString> > treesandfriends_;
 	std::vector<TString> friendaliases_;
+	std::unordered_map<std::string,std::vector<size_t> > originindex_;
+	std::unordered_map<std::string,Long64_t> entries_;
+	TString manifest_;
 
 	TChain* chain_;
 	std::vector<TChain*> friendchains_;
@@ -19,6 +19,7 @@
 #include "TString.h"
 #include <sstream>
 #include <string>
+#include <memory>
 #include "c_helper.h"
 
 /**
@@ -28,6 +29,64 @@
 template<class T>
 boost::python::numpy::ndarray STLToNumpy(const T * data, const std::vector<int>& shape, const size_t& size, bool copy=true);
 
+/**
+ * does not copy, the numpy array keeps the memory slab alive the data is part of.
+ */
+template<class T>
+boost::python::numpy::ndarray STLToNumpy(const T * data, const std::vector<int>& shape, const size_t& size,
+        const std::shared_ptr<char>& slab);
+
+/**
+ * raw strided access to the elements of a numpy array.
+ * dtype and dimensions are checked once, so no python objects are
+ * involved when reading or writing elements (e.g. without the GIL).
+ */
+template<class T>
+class numpyView{
+public:
+    numpyView(boost::python::numpy::ndarray& arr, int ndim, const std::string& caller);
+
+    template<class... I>
+    T& operator()(I... idx){
+        return data_[offset(0, idx...)];
+    }
+    size_t shape(int i)const{
+        return shape_.at(i);
+    }
+    size_t stride(int i)const{
+        return strides_.at(i);
+    }
+    /*
+     * throws if dimension i is smaller than n
+     */
+    void checkShape(int i, size_t n, const std::string& caller)const;
+
+private:
+    size_t offset(int){
+        return 0;
+    }
+    template<class... I>
+    size_t offset(int d, size_t i, I... idx){
+        return i*strides_[d] + offset(d+1, idx...);
+    }
+    T * data_;
+    std::vector<size_t> shape_, strides_;//in elements
+};
+
+/**
+ * releases the GIL in the scope of the object
+ */
+class releaseGIL{
+public:
+    releaseGIL():state_(PyEval_SaveThread()){}
+    ~releaseGIL(){
+        PyEval_RestoreThread(state_);
+    }
+private:
+    releaseGIL(const releaseGIL&);
+    PyThreadState * state_;
+};
+
 
 
 //////// template implementations
@@ -37,6 +96,10 @@ inline void destroyManagerCObject(PyObject* self) {
     auto * b = reinterpret_cast<float*>( PyCapsule_GetPointer(self, NULL) );
     delete [] b;
 }
+inline void destroySlabCObject(PyObject* self) {
+    auto * s = reinterpret_cast<std::shared_ptr<char>*>( PyCapsule_GetPointer(self, NULL) );
+    delete s;
+}
 }
 
 
@@ -80,10 +143,64 @@ boost::python::numpy::ndarray STLToNumpy(const T * data, const std::vector<int>&
     }
 }
 
+template<class T>
+boost::python::numpy::ndarray STLToNumpy(const T * data, const std::vector<int>& shape, const size_t& size,
+        const std::shared_ptr<char>& slab){
 
+    namespace p = boost::python;
+    namespace np = boost::python::numpy;
 
+    if(size>0){
+        p::list pshape;
+        size_t sizecheck = 1;
+        for(size_t i=0;i<shape.size();i++){
+            pshape.append(shape.at(i));
+            sizecheck *= shape.at(i);
+        }
+        if(sizecheck != size)
+            throw std::out_of_range("STLToNumpy: shape and size don't match");
+
+        p::tuple tshape(pshape);
+
+        PyObject *capsule = ::PyCapsule_New((void *)new std::shared_ptr<char>(slab), NULL,
+                (PyCapsule_Destructor)&_hidden::destroySlabCObject);
+        boost::python::handle<> h_capsule{capsule};
+        boost::python::object owner_capsule{h_capsule};
+
+        np::ndarray dataarr = np::from_data((void*)data,
+                np::dtype::get_builtin<T>(),
+                p::make_tuple(size), p::make_tuple(sizeof(T)), owner_capsule );
+        dataarr = dataarr.reshape(tshape);
 
+        return dataarr;
+    }
+    else{
+        return np::empty(p::make_tuple(0), np::dtype::get_builtin<T>());;
+    }
+}
 
 
+template<class T>
+numpyView<T>::numpyView(boost::python::numpy::ndarray& arr, int ndim, const std::string& caller){
+    namespace np = boost::python::numpy;
+    if(arr.get_dtype() != np::dtype::get_builtin<T>())
+        throw std::runtime_error(caller+": numpy array has wrong dtype");
+    if(arr.get_nd() != ndim)
+        throw std::out_of_range(caller+": numpy array has "+to_str(arr.get_nd())+" dimensions, expected "+to_str(ndim));
+    data_ = (T*)(void*)arr.get_data();
+    for(int i=0;i<ndim;i++){
+        if(arr.strides(i) < 0 || arr.strides(i) % sizeof(T))
+            throw std::runtime_error(caller+": numpy array strides not supported, use numpy.ascontiguousarray");
+        shape_.push_back(arr.shape(i));
+        strides_.push_back(arr.strides(i) / sizeof(T));
+    }
+}
+
+template<class T>
+void numpyView<T>::checkShape(int i, size_t n, const std::string& caller)const{
+    if(shape(i) < n)
+        throw std::out_of_range(caller+": numpy array dimension "+to_str(i)+" is "+to_str(shape(i))
+                +", needs to be at least "+to_str(n));
+}
 
 #endif /* DEEPJET_MODULES_INTERFACE_HELPER_H_ */
@@ -14,11 +14,15 @@
 #include "TString.h"
 #include <string>
 #include <vector>
+#include <memory>
 #include "TFile.h"
 #include "TTree.h"
+#include "TLeaf.h"
+#include "RVersion.h"
 
-#ifndef MAXBRANCHLENGTH
-#define MAXBRANCHLENGTH 40000
+//bulk I/O for plain float branches
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,16,0)
+#define INDATA_BULKIO
 #endif
 
 namespace __hidden{
@@ -27,9 +31,14 @@ public:
 	static bool meanPadding;
 	static bool doscaling;
 
-	indata():max(0),offset_(0),mask_(-1){
+	indata():max(0),offset_(0),mask_(-1),colfirst_(0){
 
 	}
+	/*
+	 * copies the configuration only, the copy needs its own setup
+	 */
+	indata(const indata& rhs);
+	indata& operator=(const indata& rhs);
 
 	void createFrom(std::vector<TString>  s_branches,
 			 std::vector<double>  s_norms,
@@ -59,6 +68,29 @@ public:
 		getEntry(entry);
 	}
 
+	/*
+	 * Reads the entries [first, last) of all branches into columnar buffers,
+	 * branch by branch. Plain float branches are decoded basket-wise.
+	 * Best called with consecutive ranges, e.g. from TTree::GetClusterIterator
+	 */
+	void readRange(Long64_t first, Long64_t last);
+
+	/*
+	 * values of branch b for an entry of the last range read
+	 */
+	size_t columnSize(const size_t& b, Long64_t entry)const{
+		const size_t e = entry - colfirst_;
+		return coloffsets_.at(b).at(e+1) - coloffsets_.at(b).at(e);
+	}
+	const float* columnData(const size_t& b, Long64_t entry)const{
+		return columns_.at(b).data() + coloffsets_.at(b).at(entry - colfirst_);
+	}
+	/*
+	 * value used for padding after scaling, same as from getEntry after allZero
+	 */
+	float getPadding(const size_t& b);
+	static float paddingValue(bool isvector, float mean, float norm);
+
 	bool isVector()const;
 
 	void setup(TTree* tree, const TString& treename="");
@@ -91,7 +123,24 @@ private:
 
     void handleReturns(int retcode, const TString& branchname)const;
 
+    void clearBuffers();
+
+    bool readBulk(size_t b, Long64_t first, Long64_t last);
+
     int mask_;
+
+    std::vector<TLeaf* > leaves_;
+    //owners of buffer and buffervec, sized per branch in setup
+    std::vector<std::vector<float> > bufferstore_;
+    std::vector<std::unique_ptr<std::vector<float> > > vecstore_;
+    //columnar buffers of the last range read
+    std::vector<std::vector<float> > columns_;
+    std::vector<std::vector<size_t> > coloffsets_;
+    Long64_t colfirst_;
+    //basket-wise decoded values not yet used
+    std::vector<bool> bulk_;
+    std::vector<std::vector<float> > bulkvals_;
+    std::vector<Long64_t> bulkfirst_;
 };
 
 
@@ -0,0 +1,102 @@
+/*
+ * normZeroPad.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DEEPJET_MODULES_INTERFACE_NORMZEROPAD_H_
+#define DEEPJET_MODULES_INTERFACE_NORMZEROPAD_H_
+
+#include <stddef.h>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace __hidden{
+
+/*
+ * Fused mean-normalisation and padding of one branch of one event:
+ *   dst[i*stride] = (src[i]-mean)/norm   for i < min(n, max)
+ *   dst[i*stride] = padding              for the rest up to max
+ * Only the valid values of src are read. No scaling is mean=0, norm=1.
+ * stride 1 is the flat layout, the number of branches the particle-wise one.
+ *
+ * Multiplies with the reciprocal of norm, therefore it can differ from
+ * normZeroPadReference by one ulp
+ */
+inline void normZeroPad(const float * src, size_t n, float mean, float norm, float padding,
+        float * dst, size_t max, size_t stride=1);
+
+/*
+ * scalar reference implementation
+ */
+inline void normZeroPadReference(const float * src, size_t n, float mean, float norm, float padding,
+        float * dst, size_t max, size_t stride=1){
+    for(size_t i=0;i<max;i++){
+        if(i<n)
+            dst[i*stride] = (src[i]-mean)/norm;
+        else
+            dst[i*stride] = padding;
+    }
+}
+
+namespace simd{
+#if defined(__AVX__)
+typedef __m256 vfloat;
+const size_t width = 8;
+inline vfloat set(float x){return _mm256_set1_ps(x);}
+inline vfloat load(const float * p){return _mm256_loadu_ps(p);}
+inline void store(float * p, vfloat v){_mm256_storeu_ps(p, v);}
+inline vfloat normalise(vfloat x, vfloat mean, vfloat rnorm){
+    return _mm256_mul_ps(_mm256_sub_ps(x, mean), rnorm);
+}
+#elif defined(__SSE2__)
+typedef __m128 vfloat;
+const size_t width = 4;
+inline vfloat set(float x){return _mm_set1_ps(x);}
+inline vfloat load(const float * p){return _mm_loadu_ps(p);}
+inline void store(float * p, vfloat v){_mm_storeu_ps(p, v);}
+inline vfloat normalise(vfloat x, vfloat mean, vfloat rnorm){
+    return _mm_mul_ps(_mm_sub_ps(x, mean), rnorm);
+}
+#else
+const size_t width = 1;
+#endif
+}//simd
+
+inline void normZeroPad(const float * src, size_t n, float mean, float norm, float padding,
+        float * dst, size_t max, size_t stride){
+    if(n > max)
+        n = max;
+    const float rnorm = 1.f/norm;
+    size_t i=0;
+    if(stride == 1){
+#if defined(__AVX__) || defined(__SSE2__)
+        const simd::vfloat vmean = simd::set(mean);
+        const simd::vfloat vrnorm = simd::set(rnorm);
+        const size_t nvec = n - n % simd::width;
+        for(;i<nvec;i+=simd::width)
+            simd::store(dst+i, simd::normalise(simd::load(src+i), vmean, vrnorm));
+        for(;i<n;i++)
+            dst[i] = (src[i]-mean)*rnorm;
+        const simd::vfloat vpad = simd::set(padding);
+        const size_t maxvec = max - (max-i) % simd::width;
+        for(;i<maxvec;i+=simd::width)
+            simd::store(dst+i, vpad);
+#else
+        for(;i<n;i++)
+            dst[i] = (src[i]-mean)*rnorm;
+#endif
+        for(;i<max;i++)
+            dst[i] = padding;
+        return;
+    }
+    for(;i<n;i++)
+        dst[i*stride] = (src[i]-mean)*rnorm;
+    for(;i<max;i++)
+        dst[i*stride] = padding;
+}
+
+}//__hidden
+
+#endif /* DEEPJET_MODULES_INTERFACE_NORMZEROPAD_H_ */
@@ -47,12 +47,21 @@ public:
     size_t readAll(FILE *& ifile, T * arr);
 
     //skips over the next compressed block without reading it
+    //returns in terms of T how many elements were skipped
     size_t skipBlock(FILE *& ifile);
 
     //writes header and compressed data
     //give size in terms of T
     void writeCompressed(const T * arr, size_t size, FILE *& ofile);
 
+    //compresses one chunk (at most QUICKLZ_MAXCHUNK bytes) without writing it
+    //dst needs to hold nbytes + 400 bytes. Returns the compressed size in bytes
+    size_t compressChunk(const char * src, size_t nbytes, char * dst);
+
+    //writes the header for compressed chunks that are written separately
+    //give total size in bytes
+    void writeHeader(const std::vector<size_t>& chunksizes, size_t totalbytes, FILE *& ofile);
+
 
 private:
     std::vector<size_t> chunksizes_;
@@ -99,7 +108,8 @@ void quicklz<T>::readHeader(FILE *& ifile) {
         throw std::runtime_error("quicklz<T>::readHeader: incompatible version");
     io::readFromFile(&nchunks_,  ifile);
     chunksizes_ = std::vector<size_t>(nchunks_, 0);
-    io::readFromFile(&chunksizes_[0], ifile, nchunks_);
+    if(nchunks_)
+        io::readFromFile(&chunksizes_[0], ifile, nchunks_);
     io::readFromFile(&totalbytes_, ifile);
 }
 
@@ -125,7 +135,7 @@ size_t quicklz<T>::readCompressedBlock(FILE *& ifile, T * arr){
         //std::cout << "decompress success " << readbytes << " allread " << allread << std::endl;
         chunk++;
         dst += readbytes;
-        delete src;
+        delete [] src;
     }
     if (allread != totalbytes_) {
         std::string moreinfo = "\nexpected: ";
@@ -155,6 +165,7 @@ size_t quicklz<T>::skipBlock(FILE *& ifile){
     for(const auto& c:chunksizes_)
         totalbytescompressed+=c;
     fseek(ifile,totalbytescompressed,SEEK_CUR);
+    return totalbytes_/sizeof(T);
 }
 
 template<class T>
@@ -187,21 +198,35 @@ void quicklz<T>::writeCompressed(const T * arr, size_t size, FILE *& ofile) {
             uselength = remaininglength;
             remaininglength = 0;
         }
-        size_t thissize = qlz_compress(&src[startbyte], &dst[len2], uselength,
-                state_compress_);
+        size_t thissize = compressChunk(&src[startbyte], uselength, &dst[len2]);
         chunksizes.push_back(thissize);
         len2 += thissize;
         startbyte += uselength;
     }
-    float version = DJCDATAVERSION;
-    io::writeToFile(&version,ofile);
-    io::writeToFile(&nchunks,ofile);
-    io::writeToFile(&chunksizes[0],ofile,chunksizes.size());
-    io::writeToFile(&length, ofile);
+    writeHeader(chunksizes, length, ofile);
     io::writeToFile(dst, ofile, 0, len2);
 
     //end
-    delete dst;
+    delete [] dst;
+}
+
+template<class T>
+size_t quicklz<T>::compressChunk(const char * src, size_t nbytes, char * dst){
+    return qlz_compress(src, dst, nbytes, state_compress_);
+}
+
+template<class T>
+void quicklz<T>::writeHeader(const std::vector<size_t>& chunksizes, size_t totalbytes, FILE *& ofile){
+    if(chunksizes.size() > 0xff)
+        throw std::runtime_error(
+                "quicklz::writeHeader: too many chunks");
+    uint8_t nchunks = chunksizes.size();
+    float version = DJCDATAVERSION;
+    io::writeToFile(&version,ofile);
+    io::writeToFile(&nchunks,ofile);
+    if(nchunks)
+        io::writeToFile(&chunksizes[0],ofile,chunksizes.size());
+    io::writeToFile(&totalbytes, ofile);
 }
 
 }//namespace
@@ -12,6 +12,7 @@
 #include "TGraph.h"
 #include "TH1D.h"
 #include "TChain.h"
+#include "rocIntegrator.h"
 #include <iostream>
 
 class rocCurve{
@@ -48,6 +49,11 @@ public:
 		nbins_=nbins;
 	}
 
+	/* points kept for the unbinned ROC, 0: exact (all entries) */
+	void setMaxPoints(size_t maxpoints){
+		integrator_.setMaxPoints(maxpoints);
+	}
+
 	void setLine(int col,int width=1,int style=1){
 		linecol_=col;
 		linewidth_=width;
@@ -68,13 +74,37 @@ public:
         namecp.ReplaceAll("/","_");
         return namecp;}
 
-	//now done in a simple tree-Draw way - if optmisation needed: switch to putting rocs in a loop (TBI)
-	//would need a differnet way of implementing cuts
-	void process(TChain *,std::ostream& out=std::cout);
+	//simple tree-Draw way, four passes over the chain per curve.
+	//rocCurveCollection fills all curves in one pass instead
+	void process(TTree *,std::ostream& out=std::cout);
+
+	/*
+	 * expressions as used in process: probability, and the selections
+	 * (weights) of the prob, veto, invalid and invalid-veto histograms
+	 */
+	void expressions(TString& prob, TString& probsel, TString& vetosel,
+	        TString& invalidsel, TString& invalidvetosel)const;
+
+	/*
+	 * for filling outside of process: bookHistos, fill for each entry, finish
+	 */
+	void bookHistos();
+	void fill(double prob, double probw, double vetow, double invalidw, double invalidvetow){
+	    //like TTree::Draw: the selection is the weight, 0 means not selected
+	    if(probw) probh_.Fill(prob, probw);
+	    if(vetow) vetoh_.Fill(prob, vetow);
+	    if(invalidw) invalidate_.Fill(prob, invalidw);
+	    if(invalidvetow) invalidate_veto_.Fill(prob, invalidvetow);
+	    integrator_.add(prob, probw-invalidw, vetow-invalidvetow);
+	    integrator_.addNorm(invalidw, invalidvetow);
+	}
+	void finish(std::ostream& out=std::cout);
 
 
 	TGraph* getROC(){return &roc_;}
 
+	const rocIntegrator& getIntegrator()const{return integrator_;}
+
 	const TH1D* getProbHisto()const{return &probh_;}
 	const TH1D* getVetoProbHisto()const{return &vetoh_;}
     const TH1D* getInvalidatedHisto()const{return &invalidate_;}
@@ -101,6 +131,7 @@ private:
     TH1D invalidate_,invalidate_veto_;
 
 	TGraph roc_;
+	rocIntegrator integrator_;
 	int linecol_,linewidth_,linestyle_;
 
 	bool fullanalysis_;
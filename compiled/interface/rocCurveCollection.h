@@ -19,7 +19,7 @@ class TLatex;
 
 class rocCurveCollection{
 public:
-	rocCurveCollection():leg_(0),linewidth_(2),cmsstyle_(false),logy_(true),nbins_(100){}
+	rocCurveCollection():leg_(0),linewidth_(2),cmsstyle_(false),logy_(true),nbins_(100),maxrocpoints_(10000){}
 	~rocCurveCollection(){
 		if(leg_)
 			delete leg_;
@@ -42,6 +42,14 @@ public:
         nbins_=nbins;
     }
 
+    /*
+     * bounded-memory ROC with this many points per curve (default 10000).
+     * 0: exact, keeps 12 bytes for every selected entry of every curve
+     */
+    void setMaxROCPoints(size_t maxpoints){
+        maxrocpoints_=maxpoints;
+    }
+
     void addExtraLegendEntry(const TString& entr);
 
 	void setCMSStyle(bool cmsst){cmsstyle_=cmsst;}
@@ -57,11 +65,17 @@ public:
 
 	void addText(TLatex *l){additionaltext_.push_back(l);}
 
-	void printRocs(TChain* c, const TString& outpdf,const TString&outfile="",TCanvas* cv=0, TFile * f=0,
+	void printRocs(TTree* c, const TString& outpdf,const TString&outfile="",TCanvas* cv=0, TFile * f=0,
 	        std::vector<TChain*>* chainvec=0,double xmin_in=-1,
 			TString experimentlabel="",TString lumilabel="",TString prelimlabel="");
 
 private:
+	/*
+	 * fills the given curves in one treeExpressionPass over the chain.
+	 * Curves with array expressions fall back to rocCurve::process
+	 */
+	void fillRocs(TTree* c, const std::vector<size_t>& curves, std::vector<std::ostream*>& outs);
+
 	TLegend * leg_;
 	int linewidth_;
 	std::vector<rocCurve> roccurves_;
@@ -72,6 +86,7 @@ private:
 	bool logy_;
 	TString xaxis_,yaxis_;
 	size_t nbins_;
+	size_t maxrocpoints_;
 	std::vector<TLatex *> additionaltext_;
 };
 
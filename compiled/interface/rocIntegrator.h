@@ -0,0 +1,242 @@
+/*
+ * rocIntegrator.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ROCINTEGRATOR_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ROCINTEGRATOR_H_
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+/*
+ * Unbinned ROC curves: (score, signal weight, background weight) points
+ * are sorted by descending score and swept once with running sums. The
+ * curve, the area and the working points are then read off directly.
+ *
+ * With maxpoints>0 the points are kept as a mergeable quantile sketch:
+ * whenever 2*maxpoints are buffered, neighbouring scores are merged into
+ * about maxpoints centroids of equal weight. Memory stays bounded and each
+ * centroid holds less than ~2/maxpoints of the total weight, which bounds
+ * the error on efficiency and mis-id. maxpoints=0 keeps every point (exact).
+ */
+class rocIntegrator{
+public:
+    struct point{
+        float score;
+        float sig;
+        float bkg;
+    };
+    struct workingPoint{
+        double eff;
+        double misid;
+        double score;
+    };
+
+    rocIntegrator(size_t maxpoints=0):maxpoints_(maxpoints),sigtotal_(0),bkgtotal_(0){}
+
+    void setMaxPoints(size_t maxpoints){
+        maxpoints_=maxpoints;
+        if(maxpoints_ && points_.size()>=2*maxpoints_)
+            compress();
+    }
+    size_t maxPoints()const{return maxpoints_;}
+
+    void clear(){
+        points_.clear();
+        eff_.clear();
+        misid_.clear();
+        thresh_.clear();
+        sigtotal_=0;
+        bkgtotal_=0;
+    }
+
+    bool empty()const{return points_.empty() && !sigtotal_ && !bkgtotal_;}
+    size_t size()const{return points_.size();}
+
+    void add(float score, float sig, float bkg){
+        if(!sig && !bkg)
+            return;
+        sigtotal_+=sig;
+        bkgtotal_+=bkg;
+        if(std::isnan(score))//never selected, only normalisation
+            return;
+        points_.push_back({score,sig,bkg});
+        if(maxpoints_ && points_.size()>=2*maxpoints_)
+            compress();
+    }
+
+    /* weight that only enters the normalisation, e.g. invalidated entries */
+    void addNorm(double sig, double bkg){
+        sigtotal_+=sig;
+        bkgtotal_+=bkg;
+    }
+
+    void merge(const rocIntegrator& rhs){
+        points_.insert(points_.end(),rhs.points_.begin(),rhs.points_.end());
+        sigtotal_+=rhs.sigtotal_;
+        bkgtotal_+=rhs.bkgtotal_;
+        if(maxpoints_ && points_.size()>=2*maxpoints_)
+            compress();
+    }
+
+    /*
+     * sorts the points (in parallel for nthreads>1) and sweeps them.
+     * The curve starts at the highest threshold (0,0), efficiencies
+     * and mis-ids are normalised to the total weights
+     */
+    void compute(size_t nthreads=1);
+
+    const std::vector<double>& efficiencies()const{return eff_;}
+    const std::vector<double>& misids()const{return misid_;}
+    const std::vector<double>& thresholds()const{return thresh_;}
+
+    /* integral of the mis-id over the efficiency (trapezoidal, exact for ties) */
+    double area()const;
+    /* standard AUC: integral of the efficiency over the mis-id */
+    double auc()const;
+
+    /*
+     * interpolated working point at the given mis-id / efficiency.
+     * Assumes a monotonic curve (non-negative weights)
+     */
+    workingPoint atMisid(double misid)const;
+    workingPoint atEfficiency(double eff)const;
+
+private:
+    static bool higher(const point& a, const point& b){return a.score>b.score;}
+    static void sortPoints(std::vector<point>& v, size_t nthreads);
+    workingPoint interpolate(size_t i, double frac)const;
+    void compress();
+
+    size_t maxpoints_;
+    double sigtotal_,bkgtotal_;
+    std::vector<point> points_;
+    std::vector<double> eff_,misid_,thresh_;
+};
+
+
+inline void rocIntegrator::sortPoints(std::vector<point>& v, size_t nthreads){
+    if(nthreads<2 || v.size()<(1<<16)){
+        std::sort(v.begin(),v.end(),higher);
+        return;
+    }
+    std::vector<size_t> bounds;
+    for(size_t i=0;i<=nthreads;i++)
+        bounds.push_back(v.size()*i/nthreads);
+
+    std::vector<std::thread> threads;
+    for(size_t i=0;i<nthreads;i++)
+        threads.emplace_back([&v,&bounds,i](){
+            std::sort(v.begin()+bounds[i],v.begin()+bounds[i+1],higher);});
+    for(auto& t: threads)
+        t.join();
+
+    /* pairwise merges, independent pairs in parallel */
+    for(size_t step=1;step<nthreads;step*=2){
+        threads.clear();
+        for(size_t i=0;i+step<nthreads;i+=2*step){
+            size_t last=std::min(i+2*step,nthreads);
+            threads.emplace_back([&v,&bounds,i,step,last](){
+                std::inplace_merge(v.begin()+bounds[i],v.begin()+bounds[i+step],
+                        v.begin()+bounds[last],higher);});
+        }
+        for(auto& t: threads)
+            t.join();
+    }
+}
+
+inline void rocIntegrator::compress(){
+    std::sort(points_.begin(),points_.end(),higher);
+    double total=0;
+    for(const auto& p: points_)
+        total+=std::fabs(p.sig)+std::fabs(p.bkg);
+    const double target=total/(double)maxpoints_;
+
+    std::vector<point> out;
+    out.reserve(maxpoints_+1);
+    double cw=0,cscore=0,csig=0,cbkg=0;
+    for(const auto& p: points_){
+        double w=std::fabs(p.sig)+std::fabs(p.bkg);
+        cscore+=w*p.score;
+        csig+=p.sig;
+        cbkg+=p.bkg;
+        cw+=w;
+        if(cw>=target){
+            out.push_back({(float)(cscore/cw),(float)csig,(float)cbkg});
+            cw=0;cscore=0;csig=0;cbkg=0;
+        }
+    }
+    if(cw>0)
+        out.push_back({(float)(cscore/cw),(float)csig,(float)cbkg});
+    points_.swap(out);
+}
+
+inline void rocIntegrator::compute(size_t nthreads){
+    sortPoints(points_,nthreads);
+
+    const double signorm= sigtotal_ ? 1./sigtotal_ : 0;
+    const double bkgnorm= bkgtotal_ ? 1./bkgtotal_ : 0;
+
+    eff_.assign(1,0);
+    misid_.assign(1,0);
+    thresh_.assign(1,points_.size() ? points_.front().score : 0);
+
+    double sig=0,bkg=0;
+    for(size_t i=0;i<points_.size();i++){
+        sig+=points_[i].sig;
+        bkg+=points_[i].bkg;
+        if(i+1<points_.size() && points_[i+1].score==points_[i].score)
+            continue;//ties form one step
+        eff_.push_back(sig*signorm);
+        misid_.push_back(bkg*bkgnorm);
+        thresh_.push_back(points_[i].score);
+    }
+}
+
+inline double rocIntegrator::area()const{
+    double a=0;
+    for(size_t i=1;i<eff_.size();i++)
+        a+=(eff_[i]-eff_[i-1])*(misid_[i]+misid_[i-1])/2.;
+    return a;
+}
+
+inline double rocIntegrator::auc()const{
+    double a=0;
+    for(size_t i=1;i<eff_.size();i++)
+        a+=(misid_[i]-misid_[i-1])*(eff_[i]+eff_[i-1])/2.;
+    return a;
+}
+
+inline rocIntegrator::workingPoint rocIntegrator::interpolate(size_t i, double frac)const{
+    workingPoint wp;
+    wp.eff=eff_[i-1]+frac*(eff_[i]-eff_[i-1]);
+    wp.misid=misid_[i-1]+frac*(misid_[i]-misid_[i-1]);
+    wp.score=thresh_[i];
+    return wp;
+}
+
+inline rocIntegrator::workingPoint rocIntegrator::atMisid(double misid)const{
+    if(eff_.size()<2)
+        return {0,0,0};
+    size_t i=std::lower_bound(misid_.begin()+1,misid_.end(),misid)-misid_.begin();
+    if(i>=misid_.size())
+        return {eff_.back(),misid_.back(),thresh_.back()};
+    double d=misid_[i]-misid_[i-1];
+    return interpolate(i, d>0 ? (misid-misid_[i-1])/d : 1.);
+}
+
+inline rocIntegrator::workingPoint rocIntegrator::atEfficiency(double eff)const{
+    if(eff_.size()<2)
+        return {0,0,0};
+    size_t i=std::lower_bound(eff_.begin()+1,eff_.end(),eff)-eff_.begin();
+    if(i>=eff_.size())
+        return {eff_.back(),misid_.back(),thresh_.back()};
+    double d=eff_[i]-eff_[i-1];
+    return interpolate(i, d>0 ? (eff-eff_[i-1])/d : 1.);
+}
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_ROCINTEGRATOR_H_ */
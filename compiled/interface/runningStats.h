@@ -0,0 +1,287 @@
+/*
+ * runningStats.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_RUNNINGSTATS_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_RUNNINGSTATS_H_
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <cstdint>
+
+/*
+ * Mean and variance in one pass (Welford), mergeable between threads,
+ * files and jobs (Chan et al.). Non-finite values are counted, not used.
+ * With maxpoints > 0, a weighted sample of at most ~2*maxpoints values
+ * is kept for approximate quantiles; it is mergeable as well.
+ */
+class runningStats{
+public:
+    explicit runningStats(size_t maxpoints=0):
+        n_(0),mean_(0),m2_(0),min_(std::numeric_limits<double>::max()),
+        max_(std::numeric_limits<double>::lowest()),nonfinite_(0),maxpoints_(maxpoints){}
+
+    void add(double v){
+        if(!std::isfinite(v)){
+            nonfinite_++;
+            return;
+        }
+        n_++;
+        const double d = v - mean_;
+        mean_ += d / n_;
+        m2_ += d * (v - mean_);
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+        addPoint(v, 1);
+    }
+
+    /* n values with stride, two passes over the batch and one merge */
+    void add(const float* v, size_t n, size_t stride=1);
+
+    void merge(const runningStats& rhs);
+
+    uint64_t count()const{return n_;}
+    uint64_t nonFinite()const{return nonfinite_;}
+    double mean()const{return mean_;}
+    /* population variance, as numpy.std */
+    double variance()const{return n_ ? m2_/n_ : 0;}
+    double std()const{return std::sqrt(variance());}
+    double min()const{return min_;}
+    double max()const{return max_;}
+
+    /* approximate quantile, q in [0,1]; needs maxpoints > 0 */
+    double quantile(double q)const;
+
+    void write(std::ostream& out)const;
+    void read(std::istream& in);
+
+private:
+    typedef std::pair<float,double> point;//value, weight
+
+    void addPoint(float v, double w){
+        if(!maxpoints_)
+            return;
+        points_.emplace_back(v, w);
+        if(points_.size() > 2*maxpoints_)
+            compress();
+    }
+    /* keeps about maxpoints values, each carrying the weight of its neighbours */
+    void compress();
+
+    uint64_t n_;
+    double mean_, m2_, min_, max_;
+    uint64_t nonfinite_;
+    size_t maxpoints_;
+    std::vector<point> points_;
+};
+
+/*
+ * runningStats of a set of branches: one for all values of a branch and,
+ * for vector branches, one per element up to maxelements
+ */
+class branchStatistics{
+public:
+    branchStatistics(const std::vector<std::string>& branches, size_t maxelements=0, size_t quantilepoints=0):
+        names_(branches),totals_(branches.size(), runningStats(quantilepoints)),
+        elements_(branches.size()),maxelements_(maxelements),quantilepoints_(quantilepoints){}
+
+    size_t size()const{return names_.size();}
+    const std::string& name(size_t b)const{return names_.at(b);}
+    size_t maxElements()const{return maxelements_;}
+    size_t quantilePoints()const{return quantilepoints_;}
+
+    runningStats& total(size_t b){return totals_.at(b);}
+    const runningStats& total(size_t b)const{return totals_.at(b);}
+
+    /* elements seen so far in branch b */
+    size_t nElements(size_t b)const{return elements_.at(b).size();}
+    const runningStats& element(size_t b, size_t i)const{return elements_.at(b).at(i);}
+    runningStats& element(size_t b, size_t i){
+        std::vector<runningStats>& e = elements_.at(b);
+        if(i >= e.size())
+            e.resize(i+1, runningStats(quantilepoints_));
+        return e.at(i);
+    }
+
+    /* norm as used for the conversion: the standard deviation, 1 if that is 0 */
+    double norm(size_t b)const{
+        double s = total(b).std();
+        return s ? s : 1;
+    }
+
+    /* branches need to be the same, in the same order */
+    void merge(const branchStatistics& rhs);
+
+    void write(std::ostream& out)const;
+    void read(std::istream& in);
+
+private:
+    std::vector<std::string> names_;
+    std::vector<runningStats> totals_;
+    std::vector<std::vector<runningStats> > elements_;
+    size_t maxelements_, quantilepoints_;
+};
+
+
+///implementation
+
+inline void runningStats::add(const float* v, size_t n, size_t stride){
+    runningStats batch(maxpoints_);
+    double sum=0;
+    for(size_t i=0;i<n;i++){
+        const double x = v[i*stride];
+        if(!std::isfinite(x)){
+            batch.nonfinite_++;
+            continue;
+        }
+        batch.n_++;
+        sum += x;
+        batch.min_ = std::min(batch.min_, x);
+        batch.max_ = std::max(batch.max_, x);
+    }
+    if(batch.n_){
+        batch.mean_ = sum / batch.n_;
+        for(size_t i=0;i<n;i++){
+            const double x = v[i*stride];
+            if(!std::isfinite(x))
+                continue;
+            batch.m2_ += (x - batch.mean_) * (x - batch.mean_);
+            batch.addPoint(x, 1);
+        }
+    }
+    merge(batch);
+}
+
+inline void runningStats::merge(const runningStats& rhs){
+    nonfinite_ += rhs.nonfinite_;
+    if(!rhs.n_)
+        return;
+    if(!n_){
+        n_ = rhs.n_;
+        mean_ = rhs.mean_;
+        m2_ = rhs.m2_;
+    }
+    else{
+        const double n = (double)n_ + rhs.n_;
+        const double d = rhs.mean_ - mean_;
+        mean_ += d * rhs.n_ / n;
+        m2_ += rhs.m2_ + d * d * ((double)n_ * rhs.n_ / n);
+        n_ += rhs.n_;
+    }
+    min_ = std::min(min_, rhs.min_);
+    max_ = std::max(max_, rhs.max_);
+    if(maxpoints_){
+        points_.insert(points_.end(), rhs.points_.begin(), rhs.points_.end());
+        if(points_.size() > 2*maxpoints_)
+            compress();
+    }
+}
+
+inline void runningStats::compress(){
+    std::sort(points_.begin(), points_.end());
+    double total=0;
+    for(const auto& p: points_)
+        total += p.second;
+    const double step = total / maxpoints_;
+    std::vector<point> out;
+    out.reserve(maxpoints_+1);
+    double acc=0;
+    for(const auto& p: points_){
+        acc += p.second;
+        if(acc >= step){
+            out.emplace_back(p.first, acc);
+            acc = 0;
+        }
+    }
+    if(acc > 0)
+        out.emplace_back(points_.back().first, acc);
+    points_.swap(out);
+}
+
+inline double runningStats::quantile(double q)const{
+    if(!maxpoints_)
+        throw std::runtime_error("runningStats::quantile: no quantile points configured");
+    if(points_.empty())
+        return 0;
+    std::vector<point> sorted(points_);
+    std::sort(sorted.begin(), sorted.end());
+    double total=0;
+    for(const auto& p: sorted)
+        total += p.second;
+    const double target = std::min(std::max(q, 0.), 1.) * total;
+    double acc=0;
+    for(const auto& p: sorted){
+        acc += p.second;
+        if(acc >= target)
+            return p.first;
+    }
+    return sorted.back().first;
+}
+
+inline void runningStats::write(std::ostream& out)const{
+    out << std::setprecision(17) << n_ << ' ' << mean_ << ' ' << m2_ << ' ' << min_ << ' ' << max_ << ' '
+            << nonfinite_ << ' ' << maxpoints_ << ' ' << points_.size();
+    for(const auto& p: points_)
+        out << ' ' << p.first << ' ' << p.second;
+    out << '\n';
+}
+
+inline void runningStats::read(std::istream& in){
+    size_t npoints=0;
+    in >> n_ >> mean_ >> m2_ >> min_ >> max_ >> nonfinite_ >> maxpoints_ >> npoints;
+    points_.resize(npoints);
+    for(auto& p: points_)
+        in >> p.first >> p.second;
+    if(!in)
+        throw std::runtime_error("runningStats::read: could not read statistics");
+}
+
+inline void branchStatistics::merge(const branchStatistics& rhs){
+    if(names_ != rhs.names_)
+        throw std::runtime_error("branchStatistics::merge: different branches");
+    for(size_t b=0;b<size();b++){
+        totals_.at(b).merge(rhs.totals_.at(b));
+        for(size_t i=0;i<rhs.nElements(b);i++)
+            element(b,i).merge(rhs.element(b,i));
+    }
+}
+
+inline void branchStatistics::write(std::ostream& out)const{
+    out << "branchStatistics " << size() << ' ' << maxelements_ << ' ' << quantilepoints_ << '\n';
+    for(size_t b=0;b<size();b++){
+        out << names_.at(b) << ' ' << nElements(b) << '\n';
+        totals_.at(b).write(out);
+        for(const auto& e: elements_.at(b))
+            e.write(out);
+    }
+}
+
+inline void branchStatistics::read(std::istream& in){
+    std::string tag;
+    size_t nbranches=0;
+    in >> tag >> nbranches >> maxelements_ >> quantilepoints_;
+    if(!in || tag != "branchStatistics")
+        throw std::runtime_error("branchStatistics::read: not a statistics file");
+    names_.resize(nbranches);
+    totals_.resize(nbranches);
+    elements_.resize(nbranches);
+    for(size_t b=0;b<nbranches;b++){
+        size_t nelements=0;
+        in >> names_.at(b) >> nelements;
+        totals_.at(b).read(in);
+        elements_.at(b).resize(nelements);
+        for(auto& e: elements_.at(b))
+            e.read(in);
+    }
+}
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_RUNNINGSTATS_H_ */
@@ -25,9 +25,12 @@
 #include <cstring> //memcpy
 #include "IO.h"
 #include "version.h"
+#include "arrayAllocator.h"
 #include <iostream>
 #include <cstdint>
 #include <sstream>
+#include <thread>
+#include <memory>
 
 namespace djc{
 
@@ -98,17 +101,28 @@ public:
     /////////// potentially dangerous operations for conversions, use with care ///////
 
     /*
-     * Move data memory location to another object
+     * Move data memory location to another object.
+     * It needs to be freed with allocator()->deallocate(p, allocatedBytes()),
+     * both taken before disowning.
      */
     T * disownData();
 
+    /*
+     * The allocator the data was allocated with
+     */
+    const arrayAllocator * allocator()const{
+        return allocator_;
+    }
+    size_t allocatedBytes()const{
+        return assigned_ ? 0 : capacity_ * sizeof(T);
+    }
+
     /*
      * Object will not own the data. Merely useful for conversion
      * with immediate writing to file
      */
     void assignData(T *d){
-        if(data_ && !assigned_)
-            delete data_;
+        freeData();
         data_=d;
         assigned_=true;
     }
@@ -125,12 +139,31 @@ public:
     /*
      * Splits on first axis.
      * Returns the first part, leaves the second.
-     * does memcopy for both pats now
+     * Only the returned part is copied, the second part stays in place
      */
     simpleArray<T> split(size_t splitindex);
 
+    /*
+     * Truncates on first axis, keeps the first part in place.
+     * No data is copied.
+     */
+    void truncate(size_t splitindex);
+
     simpleArray<T> getSlice(size_t splitindex_begin, size_t splitindex_end) const;
 
+    /*
+     * Number of elements (in terms of T) of a slice
+     */
+    size_t sliceSize(size_t splitindex_begin, size_t splitindex_end) const;
+
+    /*
+     * Same as getSlice, but the data is copied to target, which must hold
+     * sliceSize() elements. The returned array does not own the data but keeps
+     * the memory slab alive that target is part of.
+     */
+    simpleArray<T> sliceIntoSlab(size_t splitindex_begin, size_t splitindex_end,
+            T * target, const std::shared_ptr<char>& slab) const;
+
     /*
      *
      */
@@ -142,9 +175,30 @@ public:
     /*
      * appends along first axis
      * Cann append to an empty array (same as copy)
+     * Memory grows geometrically, so repeated appends are amortised
      */
     void append(const simpleArray<T>& a);
 
+    /*
+     * appends all arrays along first axis.
+     * The memory is allocated once, the copies run on nthreads threads
+     * (0: hardware concurrency). Empty arrays are skipped.
+     */
+    void appendMany(const std::vector<const simpleArray<T>* >& arrs, size_t nthreads=0);
+    void appendMany(const std::vector<simpleArray<T> >& arrs, size_t nthreads=0);
+
+    /*
+     * makes sure nelements (in terms of T, not first axis) fit
+     * without reallocating
+     */
+    void reserve(size_t nelements);
+
+    size_t capacity()const{
+        if(assigned_)
+            return size_;
+        return capacity_ - offset_;
+    }
+
 
 
     /* file IO here
@@ -255,6 +309,13 @@ private:
 
     void copyFrom(const simpleArray<T>& a);
     void moveFrom(simpleArray<T> && a);
+    simpleArray<T> priv_getSlice(size_t splitindex_begin, size_t splitindex_end,
+            T * target, const std::shared_ptr<char>& slab) const;
+    void allocate(size_t nelements);
+    void freeData();
+    void checkAppendable(const simpleArray<T>& a)const;
+    void appendRowSplits(const std::vector<int64_t>& rowsplits);
+    void checkSplitIndex(size_t splitindex, const std::string& caller)const;
     size_t sizeFromShape(const std::vector<int>& shape) const;
     std::vector<int> shapeFromRowsplits()const; //split dim = 1!
     void checkShape(size_t ndims)const;
@@ -277,6 +338,13 @@ private:
 #endif
 
     T * data_;
+    //data_ can point behind the start of the allocated memory after a split
+    size_t offset_;
+    //allocated number of elements, counted from the start of the allocated memory
+    size_t capacity_;
+    //set if the data is part of a shared memory slab
+    std::shared_ptr<char> slab_;
+    const arrayAllocator * allocator_;
     std::vector<int> shape_;
     //this is int64 for better feeding to TF
     std::vector<int64_t> rowsplits_;
@@ -286,12 +354,12 @@ private:
 
 template<class T>
 simpleArray<T>::simpleArray() :
-        data_(0), size_(0),assigned_(false) {
+        data_(0), offset_(0), capacity_(0), allocator_(0), size_(0),assigned_(false) {
 }
 
 template<class T>
 simpleArray<T>::simpleArray(std::vector<int> shape,const std::vector<int64_t>& rowsplits) :
-        data_(0), size_(0),assigned_(false) {
+        data_(0), offset_(0), capacity_(0), allocator_(0), size_(0),assigned_(false) {
 
     shape_ = shape;
     if(rowsplits.size()){
@@ -302,7 +370,7 @@ simpleArray<T>::simpleArray(std::vector<int> shape,const std::vector<int64_t>& r
         shape_ = shapeFromRowsplits();
     }
     size_ = sizeFromShape(shape_);
-    data_ = new T[size_];
+    allocate(size_);
 }
 
 template<class T>
@@ -333,10 +401,15 @@ simpleArray<T>::simpleArray(simpleArray<T> && a) :
         simpleArray<T>() {
     if (&a == this){
         return;}
-    if (data_&& !assigned_)
-        delete data_;
+    freeData();
     data_ = a.data_;
     a.data_ = 0;
+    offset_ = a.offset_;
+    a.offset_ = 0;
+    capacity_ = a.capacity_;
+    a.capacity_ = 0;
+    slab_ = std::move(a.slab_);
+    allocator_ = a.allocator_;
     assigned_ = a.assigned_;
     size_ = a.size_;
     a.size_ = 0;
@@ -352,10 +425,15 @@ template<class T>
 simpleArray<T>& simpleArray<T>::operator=(simpleArray<T> && a) {
     if (&a == this)
         return *this;
-    if (data_ && !assigned_)
-        delete data_;
+    freeData();
     data_ = a.data_;
     a.data_ = 0;
+    offset_ = a.offset_;
+    a.offset_ = 0;
+    capacity_ = a.capacity_;
+    a.capacity_ = 0;
+    slab_ = std::move(a.slab_);
+    allocator_ = a.allocator_;
     size_ = a.size_;
     assigned_ = a.assigned_;
     a.size_ = 0;
@@ -387,9 +465,7 @@ bool simpleArray<T>::operator==(const simpleArray<T>& rhs)const{
 
 template<class T>
 void simpleArray<T>::clear() {
-    if (data_&& !assigned_)
-        delete data_;
-    data_ = 0;
+    freeData();
     shape_.clear();
     rowsplits_.clear();
     size_ = 0;
@@ -416,8 +492,14 @@ size_t simpleArray<T>::getFirstDimension()const{
 
 template<class T>
 T * simpleArray<T>::disownData() {
+    if(offset_ && !assigned_){//the new owner needs the start of the allocated memory
+        memmove(data_ - offset_, data_, size_ * sizeof(T));
+        data_ -= offset_;
+    }
     T * dp = data_;
     data_ = 0;
+    offset_ = 0;
+    capacity_ = 0;
     return dp;
 }
 
@@ -434,55 +516,25 @@ T * simpleArray<T>::disownData() {
 template<class T>
 simpleArray<T> simpleArray<T>::split(size_t splitindex) {
     simpleArray<T> out;
-    if (!shape_.size() || ( !isRagged() && splitindex > shape_.at(0))) {
-        std::stringstream errMsg;
-        errMsg << "simpleArray<T>::split: splitindex > shape_[0] : ";
-        if(shape_.size())
-            errMsg << splitindex << ", " << shape_.at(0);
-        else
-            errMsg <<"shape size: " << shape_.size() <<" empty array cannot be split.";
-        cout();
-        throw std::runtime_error(
-                errMsg.str().c_str());
-    }
+    checkSplitIndex(splitindex, "split");
     if(splitindex == shape_.at(0)){//exactly the whole array
-        out = *this;
+        if(assigned_)
+            out = *this;
+        else
+            out = std::move(*this);
         clear();
         return out;
     }
 
-    if(isRagged() && splitindex >  rowsplits_.size()){
-        std::cout << "split index " << splitindex  << " range: " << rowsplits_.size()<< std::endl;
-        throw std::runtime_error(
-                "simpleArray<T>::split: ragged split index out of range");
-    }
-
-
     //get split point for data
-    ///insert rowsplit logic below
-    size_t splitpoint = splitindex;
-    if(isRagged()){
-        splitpoint = rowsplits_.at(splitindex);
-        for (size_t i = 2; i < shape_.size(); i++)
-            splitpoint *= (size_t)std::abs(shape_.at(i));
-    }
-    else{
-        for (size_t i = 1; i < shape_.size(); i++)
-            splitpoint *= (size_t)std::abs(shape_.at(i));
-    }
-
-
-    size_t remaining = size_ - splitpoint;
-
-    T * odata = new T[splitpoint];
-    T * rdata = new T[remaining];
-
-    memcpy(odata, data_, splitpoint * sizeof(T));
-    memcpy(rdata, data_ + splitpoint, remaining * sizeof(T));
-    if(!assigned_)
-        delete data_;
-    out.data_ = odata;
-    data_ = rdata;
+    size_t splitpoint_start, splitpoint;
+    getFlatSplitPoints(0, splitindex, splitpoint_start, splitpoint);
+
+    out.allocate(splitpoint);
+    memcpy(out.data_, data_, splitpoint * sizeof(T));
+    //the remaining part stays where it is
+    data_ += splitpoint;
+    offset_ += splitpoint;
     ///insert rowsplit logic below
     out.shape_ = shape_;
     out.shape_.at(0) = splitindex;
@@ -499,10 +551,72 @@ simpleArray<T> simpleArray<T>::split(size_t splitindex) {
     return out;
 }
 
+template<class T>
+void simpleArray<T>::truncate(size_t splitindex) {
+    checkSplitIndex(splitindex, "truncate");
+    if(splitindex == shape_.at(0))
+        return;
+
+    size_t splitpoint_start, splitpoint;
+    getFlatSplitPoints(0, splitindex, splitpoint_start, splitpoint);
+
+    //memory behind the new end is kept until the array is cleared
+    shape_.at(0) = splitindex;
+    if(isRagged()){
+        rowsplits_.resize(splitindex+1);
+        shape_ = shapeFromRowsplits();
+    }
+    size_ = splitpoint;
+}
+
+template<class T>
+void simpleArray<T>::checkSplitIndex(size_t splitindex, const std::string& caller)const{
+    if (!shape_.size() || ( !isRagged() && splitindex > shape_.at(0))) {
+        std::stringstream errMsg;
+        errMsg << "simpleArray<T>::" << caller << ": splitindex > shape_[0] : ";
+        if(shape_.size())
+            errMsg << splitindex << ", " << shape_.at(0);
+        else
+            errMsg <<"shape size: " << shape_.size() <<" empty array cannot be split.";
+        cout();
+        throw std::runtime_error(
+                errMsg.str().c_str());
+    }
+    if(isRagged() && splitindex >=  rowsplits_.size()){
+        std::cout << "split index " << splitindex  << " range: " << rowsplits_.size()<< std::endl;
+        throw std::runtime_error(
+                "simpleArray<T>::"+caller+": ragged split index out of range");
+    }
+}
+
 
 
 template<class T>
 simpleArray<T> simpleArray<T>::getSlice(size_t splitindex_begin, size_t splitindex_end) const{
+    return priv_getSlice(splitindex_begin, splitindex_end, 0, std::shared_ptr<char>());
+}
+
+template<class T>
+size_t simpleArray<T>::sliceSize(size_t splitindex_begin, size_t splitindex_end) const{
+    if(!validSlice(splitindex_begin, splitindex_end))
+        throw std::out_of_range("simpleArray<T>::sliceSize: slice out of range");
+    size_t splitpoint_start, splitpoint_end;
+    getFlatSplitPoints(splitindex_begin,splitindex_end,
+            splitpoint_start, splitpoint_end );
+    return splitpoint_end-splitpoint_start;
+}
+
+template<class T>
+simpleArray<T> simpleArray<T>::sliceIntoSlab(size_t splitindex_begin, size_t splitindex_end,
+        T * target, const std::shared_ptr<char>& slab) const{
+    if(!target || !slab)
+        throw std::runtime_error("simpleArray<T>::sliceIntoSlab: no target memory given");
+    return priv_getSlice(splitindex_begin, splitindex_end, target, slab);
+}
+
+template<class T>
+simpleArray<T> simpleArray<T>::priv_getSlice(size_t splitindex_begin, size_t splitindex_end,
+        T * target, const std::shared_ptr<char>& slab) const{
     simpleArray<T> out;
     if (!shape_.size() || ( !isRagged() && (splitindex_end > shape_.at(0) || splitindex_begin > shape_.at(0))) ) {
         std::stringstream errMsg;
@@ -515,7 +629,7 @@ simpleArray<T> simpleArray<T>::getSlice(size_t splitindex_begin, size_t splitind
         throw std::runtime_error(
                 errMsg.str().c_str());
     }
-    if(splitindex_end == shape_.at(0) && splitindex_begin==0){//exactly the whole array
+    if(!target && splitindex_end == shape_.at(0) && splitindex_begin==0){//exactly the whole array
         out = *this;
         return out;
     }
@@ -536,10 +650,15 @@ simpleArray<T> simpleArray<T>::getSlice(size_t splitindex_begin, size_t splitind
     getFlatSplitPoints(splitindex_begin,splitindex_end,
             splitpoint_start, splitpoint_end );
 
-    T * odata = new T[splitpoint_end-splitpoint_start];
-    memcpy(odata, data_+splitpoint_start, (splitpoint_end-splitpoint_start) * sizeof(T));
-
-    out.data_ = odata;
+    if(target){
+        out.data_ = target;
+        out.assigned_ = true;
+        out.slab_ = slab;
+    }
+    else{
+        out.allocate(splitpoint_end-splitpoint_start);
+    }
+    memcpy(out.data_, data_+splitpoint_start, (splitpoint_end-splitpoint_start) * sizeof(T));
 
     out.shape_ = shape_;
     out.shape_.at(0) = splitindex_end-splitindex_begin;
@@ -630,55 +749,139 @@ void simpleArray<T>::append(const simpleArray<T>& a) {
         *this = a;
         return;
     }
-    if (shape_.size() != a.shape_.size())
-        throw std::out_of_range(
-                "simpleArray<T>::append: shape dimensions don't match");
-    if(isRagged() != a.isRagged())
-        throw std::out_of_range(
-                "simpleArray<T>::append: can't append ragged to non ragged or vice versa");
+    checkAppendable(a);
+
+    //need copies in case this == &a
+    size_t asize = a.size_;
+    int afirstdim = a.shape_.at(0);
+    auto ars = a.rowsplits_;
+
+    if(assigned_ || offset_ + size_ + asize > capacity_){
+        if(!assigned_ && size_ + asize <= capacity_){//enough space in front
+            memmove(data_ - offset_, data_, size_ * sizeof(T));
+            data_ -= offset_;
+            offset_ = 0;
+        }
+        else{
+            size_t newcapacity = size_ + size_/2;
+            if(newcapacity < size_ + asize)
+                newcapacity = size_ + asize;
+            reserve(newcapacity);
+        }
+    }
+    memcpy(data_ + size_, a.data_, asize * sizeof(T));
+    size_ += asize;
 
-    std::vector<int> targetshape;
-    if (shape_.size() > 1 && a.shape_.size() > 1) {
-        size_t offset = 1;
-        if(isRagged())
-            offset = 2;
+    shape_.at(0) += afirstdim;
+    if(isRagged()){
+        appendRowSplits(ars);
+        shape_ = shapeFromRowsplits();//last
+    }
+}
 
-        std::vector<int> highshape = std::vector<int>(shape_.begin() + offset,
-                shape_.end());
-        std::vector<int> ahighshape = std::vector<int>(a.shape_.begin() + offset,
-                a.shape_.end());
-        if (highshape != ahighshape) {
-            throw std::out_of_range(
-                    "simpleArray<T>::append: all shapes but first axis must match");
+template<class T>
+void simpleArray<T>::appendMany(const std::vector<const simpleArray<T>* >& arrs, size_t nthreads){
+
+    std::vector<const simpleArray<T>* > toappend;
+    for(const auto a: arrs)
+        if(a->shape_.size())
+            toappend.push_back(a);
+    if(!toappend.size())
+        return;
+
+    if (!data_ && size_ == 0) {//start from an empty array with the right format
+        shape_ = toappend.at(0)->shape_;
+        shape_.at(0) = 0;
+        rowsplits_.clear();
+        if(toappend.at(0)->isRagged()){
+            rowsplits_.push_back(0);
+            shape_ = shapeFromRowsplits();
+        }
+    }
+
+    //need copies in case this is one of the arrays
+    std::vector<size_t> sizes, targets;
+    std::vector<std::vector<int64_t> > allrs;
+    std::vector<int> firstdims;
+    size_t total = size_;
+    for(const auto a: toappend){
+        checkAppendable(*a);
+        targets.push_back(total);
+        sizes.push_back(a->size_);
+        firstdims.push_back(a->shape_.at(0));
+        allrs.push_back(a->rowsplits_);
+        total += a->size_;
+    }
+    reserve(total);
+
+    //threads only pay off for larger copies
+    const size_t minperthread = 1 << 20;
+    if(!nthreads)
+        nthreads = std::thread::hardware_concurrency();
+    if(nthreads > (total - size_) / minperthread + 1)
+        nthreads = (total - size_) / minperthread + 1;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    //each thread copies an equal part of the new data
+    size_t start = size_;
+    auto copyrange = [&](size_t begin, size_t end){
+        for(size_t i=0;i<toappend.size();i++){
+            size_t from = std::max(begin, targets.at(i));
+            size_t to = std::min(end, targets.at(i) + sizes.at(i));
+            if(from >= to)
+                continue;
+            const T * src = toappend.at(i) == this ? data_ : toappend.at(i)->data_;
+            memcpy(data_ + from, src + (from - targets.at(i)), (to - from) * sizeof(T));
         }
-        targetshape.push_back(shape_.at(0) + a.shape_.at(0));
+    };
+    std::vector<std::thread> threads;
+    size_t perthread = (total - start) / nthreads + 1;
+    for(size_t t=1;t<nthreads;t++){
+        size_t begin = start + t * perthread;
+        if(begin >= total)
+            break;
+        threads.push_back(std::thread(copyrange, begin, std::min(total, begin + perthread)));
+    }
+    copyrange(start, std::min(total, start + perthread));
+    for(auto& t: threads)
+        t.join();
+
+    size_ = total;
+    for(size_t i=0;i<firstdims.size();i++){
+        shape_.at(0) += firstdims.at(i);
         if(isRagged())
-            targetshape.push_back(-1);
-        targetshape.insert(targetshape.end(), highshape.begin(),
-                highshape.end());
-    } else {
-        targetshape.push_back(shape_.at(0) + a.shape_.at(0));
-    }
-
-    T * ndata = new T[size_ + a.size_];
-    memcpy(ndata, data_, size_ * sizeof(T));
-    memcpy(ndata + size_, a.data_, a.size_ * sizeof(T));
-    if(!assigned_)
-        delete data_;
-    data_ = ndata;
-    size_ = size_ + a.size_;
-    ///insert rowsplit logic below
-    shape_ = targetshape;
-    //recalculate -XxY part of the shape
-    //append the row splits if dimensions match (- on same axis)
-    ///
-    if(isRagged()){
-        //need copy in case this == &a
-        auto ars = a.rowsplits_;
+            appendRowSplits(allrs.at(i));
+    }
+    if(isRagged())
+        shape_ = shapeFromRowsplits();
+}
 
-        rowsplits_ = mergeRowSplits(rowsplits_, ars);
+template<class T>
+void simpleArray<T>::appendMany(const std::vector<simpleArray<T> >& arrs, size_t nthreads){
+    std::vector<const simpleArray<T>* > ptrs;
+    for(const auto& a: arrs)
+        ptrs.push_back(&a);
+    appendMany(ptrs, nthreads);
+}
 
-        shape_ = shapeFromRowsplits();//last
+template<class T>
+void simpleArray<T>::reserve(size_t nelements){
+    if(!assigned_ && data_ && capacity_ - offset_ >= nelements)
+        return;
+    if(nelements < size_)
+        nelements = size_;
+    T * olddata = data_;
+    size_t oldoffset = offset_;
+    bool oldassigned = assigned_;
+    auto oldslab = slab_;//keep alive until copied
+    auto oldallocator = allocator_;
+    size_t oldcapacity = capacity_;
+    allocate(nelements);
+    if(olddata){
+        memcpy(data_, olddata, size_ * sizeof(T));
+        if(!oldassigned)
+            oldallocator->deallocate(olddata - oldoffset, oldcapacity * sizeof(T));
     }
 }
 
@@ -731,7 +934,7 @@ void simpleArray<T>::readFromFileP(FILE *& ifile) {
         iqlz.readAll(ifile, &rowsplits_[0]);
     }
     quicklz<T> qlz;
-    data_ = new T[size_];
+    allocate(size_);
     size_t nread = qlz.readAll(ifile, data_);
     if (nread != size_)
         throw std::runtime_error(
@@ -1001,15 +1204,68 @@ void simpleArray<T>::copyFrom(const simpleArray<T>& a) {
     if (&a == this) {
         return;
     }
-    if (data_&& !assigned_)
-        delete data_;
-    data_ = new T[a.size_];
+    freeData();
+    allocate(a.size_);
     memcpy(data_, a.data_, a.size_ * sizeof(T));
 
     size_ = a.size_;
     shape_ = a.shape_;
     rowsplits_ = a.rowsplits_;
-    assigned_=false;
+}
+
+template<class T>
+void simpleArray<T>::allocate(size_t nelements) {
+    allocator_ = currentArrayAllocator();
+    data_ = (T*)allocator_->allocate(nelements * sizeof(T));
+    offset_ = 0;
+    capacity_ = nelements;
+    assigned_ = false;
+    slab_.reset();
+}
+
+template<class T>
+void simpleArray<T>::freeData() {
+    if (data_ && !assigned_)
+        allocator_->deallocate(data_ - offset_, capacity_ * sizeof(T));
+    data_ = 0;
+    offset_ = 0;
+    capacity_ = 0;
+    slab_.reset();
+}
+
+template<class T>
+void simpleArray<T>::checkAppendable(const simpleArray<T>& a)const{
+    if (shape_.size() != a.shape_.size())
+        throw std::out_of_range(
+                "simpleArray<T>::append: shape dimensions don't match");
+    if(isRagged() != a.isRagged())
+        throw std::out_of_range(
+                "simpleArray<T>::append: can't append ragged to non ragged or vice versa");
+    size_t offset = 1;
+    if(isRagged())
+        offset = 2;
+    for(size_t i=offset;i<shape_.size();i++){
+        if(shape_.at(i) != a.shape_.at(i))
+            throw std::out_of_range(
+                    "simpleArray<T>::append: all shapes but first axis must match");
+    }
+}
+
+/*
+ * in place version of mergeRowSplits
+ */
+template<class T>
+void simpleArray<T>::appendRowSplits(const std::vector<int64_t>& rowsplits){
+    if(rowsplits.size()<1)
+        return;
+    if(rowsplits_.size()<1){
+        rowsplits_ = rowsplits;
+        return;
+    }
+    int64_t last = rowsplits_.at(rowsplits_.size()-1);
+    rowsplits_.reserve(rowsplits_.size() + rowsplits.size() - 1);
+    for(size_t i=1;i<rowsplits.size();i++)
+        rowsplits_.push_back(last + rowsplits.at(i));
 }
 
 template<class T>
@@ -1284,8 +1540,7 @@ void simpleArray<T>::fromNumpy(const boost::python::numpy::ndarray& ndarr,
     size_ = sizeFromShape(shape_);
 
     if(copy){
-        assigned_=false;
-        data_ = new T[size_];
+        allocate(size_);
         memcpy(data_, npdata, size_* sizeof(T));
     }
     else{
@@ -1335,9 +1590,21 @@ boost::python::tuple simpleArray<T>::transferToNumpy(bool pad_rowsplits){
     namespace np = boost::python::numpy;
 
     auto shape = makeNumpyShape();
-    T * data_ptr = disownData();
-
-    np::ndarray dataarr = STLToNumpy<T>(data_ptr, shape, size(), false);
+    np::ndarray dataarr = np::empty(p::make_tuple(0), np::dtype::get_builtin<T>());
+    if(slab_){//numpy keeps the slab alive instead of owning the data
+        dataarr = STLToNumpy<T>(data_, shape, size(), slab_);
+    }
+    else if(assigned_){
+        dataarr = STLToNumpy<T>(data_, shape, size(), true);
+    }
+    else{//numpy frees the memory with the right allocator
+        auto alloc = allocator_;
+        size_t nbytes = capacity_ * sizeof(T);
+        std::shared_ptr<char> owner((char*)(void*)(data_ - offset_),
+                [alloc, nbytes](char * p){ alloc->deallocate(p, nbytes); });
+        dataarr = STLToNumpy<T>(data_, shape, size(), owner);
+        data_ = 0;//now owned by numpy
+    }
     if(pad_rowsplits){
         auto rsp = padRowsplits();
         np::ndarray rowsplits = STLToNumpy<int64_t>(&(rsp[0]), {(int)rsp.size()}, rsp.size(), true);
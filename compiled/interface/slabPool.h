@@ -0,0 +1,135 @@
+/*
+ * slabPool.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SLABPOOL_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SLABPOOL_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdlib.h>
+#include <stdexcept>
+
+namespace djc{
+
+/*
+ * Pool of aligned memory slabs.
+ * A slab is handed out as shared pointer. Once the last user (e.g. a numpy
+ * array the data was transferred to) releases it, it goes back to the pool
+ * and is reused for the next request that fits into it.
+ * Slabs can outlive the pool, they are freed then.
+ */
+class slabPool{
+public:
+    static const size_t alignment = 64;
+
+    slabPool(size_t maxfree=4):state_(std::make_shared<state>()){
+        state_->maxfree=maxfree;
+    }
+    ~slabPool(){
+        clear();
+    }
+
+    /*
+     * returns a slab of at least nbytes
+     */
+    std::shared_ptr<char> get(size_t nbytes);
+
+    /*
+     * maximum number of unused slabs kept
+     */
+    void setMaxFree(size_t maxfree){
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->maxfree=maxfree;
+    }
+
+    /*
+     * frees all unused slabs
+     */
+    void clear();
+
+    static size_t alignedSize(size_t nbytes){
+        return (nbytes + alignment - 1) / alignment * alignment;
+    }
+
+    //copies start with an empty pool
+    slabPool(const slabPool& rhs):slabPool(rhs.state_->maxfree){}
+    slabPool& operator=(const slabPool& rhs){
+        if(this != &rhs)
+            setMaxFree(rhs.state_->maxfree);
+        return *this;
+    }
+
+private:
+
+    struct slab{
+        char * mem;
+        size_t size;
+    };
+    struct state{
+        std::mutex mutex;
+        std::vector<slab> free;
+        size_t maxfree;
+    };
+
+    static void release(const std::weak_ptr<state>& s, slab sl);
+
+    std::shared_ptr<state> state_;
+};
+
+
+inline std::shared_ptr<char> slabPool::get(size_t nbytes){
+    nbytes = alignedSize(nbytes);
+    if(!nbytes)
+        nbytes = alignment;
+    slab sl = {0, 0};
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        //best fit, but don't waste large slabs on small requests
+        size_t best = state_->free.size();
+        for(size_t i=0;i<state_->free.size();i++){
+            const auto& f = state_->free.at(i);
+            if(f.size < nbytes || f.size > 2*nbytes)
+                continue;
+            if(best == state_->free.size() || f.size < state_->free.at(best).size)
+                best = i;
+        }
+        if(best < state_->free.size()){
+            sl = state_->free.at(best);
+            state_->free.erase(state_->free.begin()+best);
+        }
+    }
+    if(!sl.mem){
+        sl.mem = (char*)aligned_alloc(alignment, nbytes);
+        if(!sl.mem)
+            throw std::bad_alloc();
+        sl.size = nbytes;
+    }
+    std::weak_ptr<state> ws = state_;
+    return std::shared_ptr<char>(sl.mem, [ws, sl](char *){ release(ws, sl); });
+}
+
+inline void slabPool::release(const std::weak_ptr<state>& ws, slab sl){
+    if(auto s = ws.lock()){
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if(s->free.size() < s->maxfree){
+            s->free.push_back(sl);
+            return;
+        }
+    }
+    free(sl.mem);
+}
+
+inline void slabPool::clear(){
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for(auto& sl: state_->free)
+        free(sl.mem);
+    state_->free.clear();
+}
+
+}//namespace
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SLABPOOL_H_ */
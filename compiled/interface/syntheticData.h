@@ -0,0 +1,302 @@
+/*
+ * syntheticData.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SYNTHETICDATA_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SYNTHETICDATA_H_
+
+#include "simpleArray.h"
+#include "trainData.h"
+#include "fastRandom.h"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace djc{
+
+/*
+ * Number of candidates per entry, from a spec string:
+ *  fixed:n
+ *  uniform:min:max
+ *  exp:mean:max        1 + exponential, cut at max
+ *  pareto:min:alpha:max long tail, cut at max
+ */
+class multiplicityDistribution{
+public:
+    enum kinden {en_fixed, en_uniform, en_exp, en_pareto};
+
+    explicit multiplicityDistribution(const std::string& spec="exp:12:400");
+
+    int draw(fastRandom& rand)const;
+    int max()const{return max_;}
+
+private:
+    kinden kind_;
+    double a_, b_;
+    int max_;
+};
+
+/*
+ * One array of a synthetic trainData, from a spec string:
+ *  flat:n      [entries, n]
+ *  dense:nxf   [entries, n, f], the first candidates filled, zero-padded
+ *  ragged:f    [entries, -candidates, f]
+ *  onehot:n    [entries, n], one class per entry
+ * All ragged arrays of an entry have the same number of candidates.
+ */
+struct syntheticArray{
+    enum kinden {en_flat, en_dense, en_ragged, en_onehot};
+
+    explicit syntheticArray(const std::string& spec);
+
+    kinden kind;
+    int n, features;
+};
+
+/*
+ * Blocks of trainData with feature, truth and weight arrays as specified.
+ * Values are normal distributed and rounded to 'decimals' decimals
+ * (none for decimals < 0); rounding and padding make the data about
+ * as compressible as typical inputs.
+ */
+class syntheticData{
+public:
+    syntheticData(const std::string& features, const std::string& truths,
+            const std::string& weights="", const std::string& multiplicity="exp:12:400",
+            int decimals=2);
+
+    trainData<float> block(size_t nentries, fastRandom& rand)const;
+
+    /* a single array for given candidate numbers */
+    static simpleArray<float> makeArray(const syntheticArray& spec, const std::vector<int>& ncand,
+            fastRandom& rand, int decimals);
+
+    /* comma separated array specs, empty for none */
+    static std::vector<syntheticArray> parse(const std::string& specs);
+
+    /* bytes per entry on average, before compression */
+    double bytesPerEntry()const;
+
+private:
+    static float value(fastRandom& rand, int decimals);
+
+    std::vector<syntheticArray> features_, truths_, weights_;
+    multiplicityDistribution mult_;
+    int decimals_;
+};
+
+
+///implementation
+
+static inline std::vector<std::string> splitSpec(const std::string& s, char sep){
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while(std::getline(ss, item, sep))
+        out.push_back(item);
+    return out;
+}
+
+inline multiplicityDistribution::multiplicityDistribution(const std::string& spec):a_(0),b_(0),max_(0){
+    std::vector<std::string> p = splitSpec(spec, ':');
+    try{
+        if(p.size()==2 && p.at(0)=="fixed"){
+            kind_=en_fixed;
+            max_=std::stoi(p.at(1));
+        }
+        else if(p.size()==3 && p.at(0)=="uniform"){
+            kind_=en_uniform;
+            a_=std::stoi(p.at(1));
+            max_=std::stoi(p.at(2));
+        }
+        else if(p.size()==3 && p.at(0)=="exp"){
+            kind_=en_exp;
+            a_=std::stod(p.at(1));
+            max_=std::stoi(p.at(2));
+        }
+        else if(p.size()==4 && p.at(0)=="pareto"){
+            kind_=en_pareto;
+            a_=std::stod(p.at(1));
+            b_=std::stod(p.at(2));
+            max_=std::stoi(p.at(3));
+        }
+        else
+            throw std::invalid_argument(spec);
+    }
+    catch(std::logic_error&){
+        throw std::runtime_error("multiplicityDistribution: invalid spec "+spec
+                +", use fixed:n, uniform:min:max, exp:mean:max or pareto:min:alpha:max");
+    }
+    if(max_<1 || a_<0 || a_>max_ || (kind_==en_pareto && (b_<=0 || a_<1)))
+        throw std::runtime_error("multiplicityDistribution: invalid parameters in "+spec);
+}
+
+inline int multiplicityDistribution::draw(fastRandom& rand)const{
+    double n=max_;
+    switch(kind_){
+    case en_fixed:
+        break;
+    case en_uniform:
+        n = a_ + rand.below(max_-(int)a_+1);
+        break;
+    case en_exp:
+        n = 1 + std::floor(-(a_-1)*std::log(1.-rand.uniform()));
+        break;
+    case en_pareto:
+        n = std::floor(a_ / std::pow(1.-rand.uniform(), 1./b_));
+        break;
+    }
+    return (int)std::min(n, (double)max_);
+}
+
+inline syntheticArray::syntheticArray(const std::string& spec):kind(en_flat),n(0),features(0){
+    std::vector<std::string> p = splitSpec(spec, ':');
+    try{
+        if(p.size()!=2)
+            throw std::invalid_argument(spec);
+        if(p.at(0)=="flat" || p.at(0)=="onehot"){
+            kind = p.at(0)=="flat" ? en_flat : en_onehot;
+            n = std::stoi(p.at(1));
+        }
+        else if(p.at(0)=="dense"){
+            kind = en_dense;
+            std::vector<std::string> d = splitSpec(p.at(1), 'x');
+            if(d.size()!=2)
+                throw std::invalid_argument(spec);
+            n = std::stoi(d.at(0));
+            features = std::stoi(d.at(1));
+        }
+        else if(p.at(0)=="ragged"){
+            kind = en_ragged;
+            features = std::stoi(p.at(1));
+        }
+        else
+            throw std::invalid_argument(spec);
+    }
+    catch(std::logic_error&){
+        throw std::runtime_error("syntheticArray: invalid spec "+spec
+                +", use flat:n, dense:nxf, ragged:f or onehot:n");
+    }
+    if((kind!=en_ragged && n<1) || ((kind==en_dense || kind==en_ragged) && features<1))
+        throw std::runtime_error("syntheticArray: invalid size in "+spec);
+}
+
+inline syntheticData::syntheticData(const std::string& features, const std::string& truths,
+        const std::string& weights, const std::string& multiplicity, int decimals):
+        features_(parse(features)),truths_(parse(truths)),weights_(parse(weights)),
+        mult_(multiplicity),decimals_(decimals){
+    if(features_.empty())
+        throw std::runtime_error("syntheticData: at least one feature array needed");
+}
+
+inline std::vector<syntheticArray> syntheticData::parse(const std::string& specs){
+    std::vector<syntheticArray> out;
+    for(const auto& s: splitSpec(specs, ','))
+        if(s.size())
+            out.push_back(syntheticArray(s));
+    return out;
+}
+
+inline float syntheticData::value(fastRandom& rand, int decimals){
+    //Box-Muller, one of the two values
+    const double u1 = 1.-rand.uniform(), u2 = rand.uniform();
+    float v = std::sqrt(-2.*std::log(u1)) * std::cos(2.*M_PI*u2);
+    if(decimals>=0){
+        const float scale = std::pow(10.f, decimals);
+        v = std::round(v*scale)/scale;
+    }
+    return v;
+}
+
+inline simpleArray<float> syntheticData::makeArray(const syntheticArray& spec, const std::vector<int>& ncand,
+        fastRandom& rand, int decimals){
+    const int nentries = ncand.size();
+    switch(spec.kind){
+    case syntheticArray::en_flat:{
+        simpleArray<float> a({nentries, spec.n});
+        for(size_t i=0;i<a.size();i++)
+            a.data()[i] = value(rand, decimals);
+        return a;
+    }
+    case syntheticArray::en_onehot:{
+        simpleArray<float> a({nentries, spec.n});
+        std::fill(a.data(), a.data()+a.size(), 0.f);
+        for(int e=0;e<nentries;e++)
+            a.data()[e*spec.n + rand.below(spec.n)] = 1;
+        return a;
+    }
+    case syntheticArray::en_dense:{
+        simpleArray<float> a({nentries, spec.n, spec.features});
+        std::fill(a.data(), a.data()+a.size(), 0.f);
+        float * d = a.data();
+        for(int e=0;e<nentries;e++){
+            const size_t nfilled = std::min(ncand.at(e), spec.n) * spec.features;
+            for(size_t i=0;i<nfilled;i++)
+                d[i] = value(rand, decimals);
+            d += spec.n * spec.features;
+        }
+        return a;
+    }
+    case syntheticArray::en_ragged:{
+        std::vector<int64_t> rowsplits(1, 0);
+        for(const auto& n: ncand)
+            rowsplits.push_back(rowsplits.back() + n);
+        simpleArray<float> a({nentries, -1, spec.features}, rowsplits);
+        for(size_t i=0;i<a.size();i++)
+            a.data()[i] = value(rand, decimals);
+        return a;
+    }
+    }
+    throw std::logic_error("syntheticData::makeArray: unknown array kind");
+}
+
+inline trainData<float> syntheticData::block(size_t nentries, fastRandom& rand)const{
+    std::vector<int> ncand(nentries);
+    for(auto& n: ncand)
+        n = mult_.draw(rand);
+    trainData<float> td;
+    for(const auto& s: features_){
+        simpleArray<float> a = makeArray(s, ncand, rand, decimals_);
+        td.storeFeatureArray(a);
+    }
+    for(const auto& s: truths_){
+        simpleArray<float> a = makeArray(s, ncand, rand, decimals_);
+        td.storeTruthArray(a);
+    }
+    for(const auto& s: weights_){
+        simpleArray<float> a = makeArray(s, ncand, rand, decimals_);
+        td.storeWeightArray(a);
+    }
+    return td;
+}
+
+inline double syntheticData::bytesPerEntry()const{
+    //mean multiplicity from a fixed sample
+    fastRandom rand(1);
+    double mean=0;
+    const size_t nsample=10000;
+    for(size_t i=0;i<nsample;i++)
+        mean += mult_.draw(rand);
+    mean /= nsample;
+    double floats=0;
+    for(const auto* arrays: {&features_, &truths_, &weights_}){
+        for(const auto& s: *arrays){
+            switch(s.kind){
+            case syntheticArray::en_flat:
+            case syntheticArray::en_onehot: floats += s.n; break;
+            case syntheticArray::en_dense: floats += s.n * s.features; break;
+            case syntheticArray::en_ragged: floats += mean * s.features; break;
+            }
+        }
+    }
+    return floats * sizeof(float);
+}
+
+}//namespace
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_SYNTHETICDATA_H_ */
@@ -19,6 +19,7 @@
 #endif
 
 #include "simpleArray.h"
+#include "slabPool.h"
 #include <stdio.h>
 #include "IO.h"
 
@@ -81,12 +82,24 @@ public:
      */
     void append(const trainData<T>& );
 
+    /*
+     * append all along first axis, allocating the memory only once.
+     * Copies run on nthreads threads (0: hardware concurrency)
+     */
+    void appendMany(const std::vector<const trainData<T>* >&, size_t nthreads=0);
+    void appendMany(const std::vector<trainData<T> >&, size_t nthreads=0);
+
     /*
      * split along first axis
      * Returns the second part, leaves the first.
      */
     trainData<T> split(size_t splitindex);
     trainData<T> getSlice(size_t splitindex_begin, size_t splitindex_end)const;
+    /*
+     * Same as getSlice, but all arrays are carved from one slab of the pool,
+     * each aligned to slabPool::alignment
+     */
+    trainData<T> getSlice(size_t splitindex_begin, size_t splitindex_end, slabPool& pool)const;
 
     trainData<T> shuffle(const std::vector<size_t>& shuffle_idxs)const;
 
@@ -146,6 +159,8 @@ public:
 
 #ifdef DJC_DATASTRUCTURE_PYTHON_BINDINGS
 
+    void appendManyP(boost::python::list tds);
+
     boost::python::list getKerasFeatureShapes()const;
     boost::python::list getKerasFeatureDTypes()const;
     // not needed boost::python::list getKerasTruthShapes()const;
@@ -154,6 +169,8 @@ public:
     //data generator interface get back numpy arrays / tf.tensors here for keras feeding!
 
     boost::python::list getTruthRaggedFlags()const;
+    boost::python::list getFeatureRaggedFlags()const;
+    boost::python::list getWeightRaggedFlags()const;
 
 
     boost::python::list  featureList();
@@ -256,7 +273,13 @@ int trainData<T>::storeWeightArray(simpleArray<T> & a){
  */
 template<class T>
 void trainData<T>::truncate(size_t position){
-    *this = split(position);
+    for (auto& a : feature_arrays_)
+        a.truncate(position);
+    for (auto& a : truth_arrays_)
+        a.truncate(position);
+    for (auto& a : weight_arrays_)
+        a.truncate(position);
+    updateShapes();
 }
 
 /*
@@ -291,11 +314,65 @@ void trainData<T>::append(const trainData<T>& td) {
     updateShapes();
 }
 
+template<class T>
+void trainData<T>::appendMany(const std::vector<const trainData<T>* >& tds, size_t nthreads) {
+    std::vector<const trainData<T>* > toappend;
+    for(const auto td: tds){
+        if(!td->feature_arrays_.size() && !td->truth_arrays_.size()
+                && !td->weight_arrays_.size())
+            continue; //nothing to do
+        toappend.push_back(td);
+    }
+    if(!toappend.size())
+        return;
+    //allow empty append
+    if (!feature_arrays_.size() && !truth_arrays_.size()
+            && !weight_arrays_.size()) {
+        feature_arrays_.resize(toappend.at(0)->feature_arrays_.size());
+        truth_arrays_.resize(toappend.at(0)->truth_arrays_.size());
+        weight_arrays_.resize(toappend.at(0)->weight_arrays_.size());
+    }
+    for(const auto td: toappend){
+        if (feature_arrays_.size() != td->feature_arrays_.size()
+                || truth_arrays_.size() != td->truth_arrays_.size()
+                || weight_arrays_.size() != td->weight_arrays_.size()) {
+            std::cout << "nfeat " << feature_arrays_.size() << "-" << td->feature_arrays_.size() <<'\n'
+                    << "ntruth " << truth_arrays_.size() << "-" << td->truth_arrays_.size()<<'\n'
+                    << "nweights " << weight_arrays_.size() << "-" <<  td->weight_arrays_.size() <<std::endl;
+            throw std::out_of_range("trainData<T>::appendMany: format not compatible.");
+        }
+    }
+    std::vector<const simpleArray<T>* > arrs(toappend.size());
+    for(size_t i=0;i<feature_arrays_.size();i++){
+        for(size_t j=0;j<toappend.size();j++)
+            arrs.at(j) = &toappend.at(j)->feature_arrays_.at(i);
+        feature_arrays_.at(i).appendMany(arrs, nthreads);
+    }
+    for(size_t i=0;i<truth_arrays_.size();i++){
+        for(size_t j=0;j<toappend.size();j++)
+            arrs.at(j) = &toappend.at(j)->truth_arrays_.at(i);
+        truth_arrays_.at(i).appendMany(arrs, nthreads);
+    }
+    for(size_t i=0;i<weight_arrays_.size();i++){
+        for(size_t j=0;j<toappend.size();j++)
+            arrs.at(j) = &toappend.at(j)->weight_arrays_.at(i);
+        weight_arrays_.at(i).appendMany(arrs, nthreads);
+    }
+    updateShapes();
+}
+
+template<class T>
+void trainData<T>::appendMany(const std::vector<trainData<T> >& tds, size_t nthreads) {
+    std::vector<const trainData<T>* > ptrs;
+    for(const auto& td: tds)
+        ptrs.push_back(&td);
+    appendMany(ptrs, nthreads);
+}
+
 /*
  * split along first axis
  * Returns the first part, leaves the second.
- *
- * Can use some performance improvements
+ * Only the returned part is copied.
  */
 template<class T>
 trainData<T> trainData<T>::split(size_t splitindex) {
@@ -326,6 +403,33 @@ trainData<T> trainData<T>::getSlice(size_t splitindex_begin, size_t splitindex_e
     return out;
 }
 
+template<class T>
+trainData<T> trainData<T>::getSlice(size_t splitindex_begin, size_t splitindex_end, slabPool& pool)const{
+    trainData<T> out;
+
+    size_t nbytes = 0;
+    for (const auto* arrays : {&feature_arrays_, &truth_arrays_, &weight_arrays_})
+        for (const auto& a : *arrays)
+            nbytes += slabPool::alignedSize(a.sliceSize(splitindex_begin,splitindex_end) * sizeof(T));
+    auto slab = pool.get(nbytes);
+
+    char * pos = slab.get();
+    auto carve = [&](const simpleArray<T>& a){
+        auto sliced = a.sliceIntoSlab(splitindex_begin,splitindex_end,(T*)(void*)pos,slab);
+        pos += slabPool::alignedSize(sliced.size() * sizeof(T));
+        return sliced;
+    };
+    for (const auto& a : feature_arrays_)
+        out.feature_arrays_.push_back(carve(a));
+    for (const auto& a : truth_arrays_)
+        out.truth_arrays_.push_back(carve(a));
+    for (const auto& a : weight_arrays_)
+        out.weight_arrays_.push_back(carve(a));
+
+    out.updateShapes();
+    return out;
+}
+
 template<class T>
 trainData<T> trainData<T>::shuffle(const std::vector<size_t>& shuffle_idxs)const{
     trainData<T> out;
@@ -393,7 +497,7 @@ void trainData<T>::priv_readFromFile(std::string filename, bool memcp){
         buf = new char[fsize];
         int ret = fread(buf, 1, fsize, diskfile);
         if(!ret){
-            delete buf;
+            delete [] buf;
             throw std::runtime_error("trainData<T>::readFromFile: could not read file in memcp mode");
         }
         fclose(diskfile);
@@ -413,7 +517,7 @@ void trainData<T>::priv_readFromFile(std::string filename, bool memcp){
     fclose(ifile);
     //std::cout << "read done, free"<<std::endl;
     if(buf){
-        delete buf;
+        delete [] buf;
     }
 
 }
@@ -585,24 +689,29 @@ template<class T>
 void trainData<T>::skim(size_t batchelement){
     if(batchelement > nElements())
         throw std::out_of_range("trainData<T>::skim: batch element out of range");
-    for(auto & a : feature_arrays_){
-        a.split(batchelement);
-        a=a.split(1);
-    }
-    for(auto & a : truth_arrays_){
-        a.split(batchelement);
-        a=a.split(1);
-    }
-    for(auto & a : weight_arrays_){
-        a.split(batchelement);
-        a=a.split(1);
-    }
+    //only the skimmed element is copied
+    for(auto & a : feature_arrays_)
+        a = a.getSlice(batchelement, batchelement+1);
+    for(auto & a : truth_arrays_)
+        a = a.getSlice(batchelement, batchelement+1);
+    for(auto & a : weight_arrays_)
+        a = a.getSlice(batchelement, batchelement+1);
     updateShapes();
 }
 
 
 #ifdef DJC_DATASTRUCTURE_PYTHON_BINDINGS
 
+template<class T>
+void trainData<T>::appendManyP(boost::python::list tds){
+    std::vector<const trainData<T>* > ptrs;
+    for(size_t i=0;i<boost::python::len(tds);i++){
+        const trainData<T>& td = boost::python::extract<const trainData<T>&>(tds[i]);
+        ptrs.push_back(&td);
+    }
+    appendMany(ptrs);
+}
+
 template<class T>
 boost::python::list trainData<T>::getKerasFeatureShapes()const{
     boost::python::list out;
@@ -676,6 +785,36 @@ template<class T>
 boost::python::list trainData<T>::getTruthRaggedFlags()const{
     boost::python::list out;
     for(const auto& a: truth_shapes_){
+        bool isragged = false;
+        for(const auto & s: a)
+            if(s<0){
+                isragged=true;
+                break;
+            }
+        out.append(isragged);
+    }
+    return out;
+}
+
+template<class T>
+boost::python::list trainData<T>::getFeatureRaggedFlags()const{
+    boost::python::list out;
+    for(const auto& a: feature_shapes_){
+        bool isragged = false;
+        for(const auto & s: a)
+            if(s<0){
+                isragged=true;
+                break;
+            }
+        out.append(isragged);
+    }
+    return out;
+}
+
+template<class T>
+boost::python::list trainData<T>::getWeightRaggedFlags()const{
+    boost::python::list out;
+    for(const auto& a: weight_shapes_){
         bool isragged = false;
         for(const auto & s: a)
             if(s<0){
@@ -86,6 +86,17 @@ public:
         filetimeout_=seconds;
     }
 
+    /**
+     * All arrays of a batch are carved from one aligned memory slab.
+     * Slabs are recycled once the batch (or the numpy arrays it was
+     * transferred to) is released
+     */
+    void setUseArena(bool usearena){
+        usearena_=usearena;
+        if(!usearena_)
+            slabs_.clear();
+    }
+
     int getNBatches()const{return nbatches_;}
 
     bool lastBatch()const;
@@ -152,6 +163,8 @@ private:
     size_t filetimeout_;
     size_t batchcount_;
     size_t lastbuffersplit_;
+    bool usearena_;
+    slabPool slabs_;
 };
 
 
@@ -159,7 +172,7 @@ template<class T>
 trainDataGenerator<T>::trainDataGenerator() :debuglevel(0),
         randomcount_(1), batchsize_(2),sqelementslimit_(false),skiplargebatches_(true), readthread_(0), nextreadIdx_(0), filecount_(0), nbatches_(
                 0), npossiblebatches_(0), ntotal_(0), nsamplesprocessed_(0),lastbatchsize_(0),filetimeout_(10),
-                batchcount_(0),lastbuffersplit_(0){
+                batchcount_(0),lastbuffersplit_(0),usearena_(false){
 }
 
 template<class T>
@@ -546,7 +559,11 @@ trainData<T>  trainDataGenerator<T>::prepareBatch(){
     }
 
     //auto thisbatch = buffer_store.split(expect_batchelements);
-    auto thisbatch = buffer_store.getSlice(lastbuffersplit_, lastbuffersplit_+expect_batchelements);
+    trainData<T> thisbatch;
+    if(usearena_)
+        thisbatch = buffer_store.getSlice(lastbuffersplit_, lastbuffersplit_+expect_batchelements, slabs_);
+    else
+        thisbatch = buffer_store.getSlice(lastbuffersplit_, lastbuffersplit_+expect_batchelements);
 
     lastbuffersplit_+=expect_batchelements;
     // validSlice
@@ -0,0 +1,382 @@
+/*
+ * trainDataStreamWriter.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TRAINDATASTREAMWRITER_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TRAINDATASTREAMWRITER_H_
+
+#include "trainData.h"
+#include "quicklzWrapper.h"
+#include "IO.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+
+namespace djc{
+
+/*
+ * Writes a trainData file incrementally, without keeping the arrays in memory.
+ * Row blocks are collected per array until a chunk is full, the chunk is then
+ * compressed on a background thread and spooled to a temporary file next to
+ * the output. The shapes, row splits and compression headers are only known
+ * at the end and are written by close(), which assembles the final file.
+ * The result is identical in format to trainData<T>::writeToFile.
+ *
+ * Chunk sizes are in bytes. All chunks but the last of an array have this size,
+ * a single array can have at most 255 chunks.
+ */
+template<class T>
+class trainDataStreamWriter{
+public:
+    trainDataStreamWriter(const std::string& filename, size_t nthreads=2,
+            size_t chunkbytes=(size_t)256 << 20);
+    ~trainDataStreamWriter();
+
+    /*
+     * Appends rows along the first axis. The first block with a new index
+     * defines the array format, the index must be the next free one.
+     */
+    void appendFeatureRows(size_t idx, const simpleArray<T>& block);
+    void appendTruthRows(size_t idx, const simpleArray<T>& block);
+    void appendWeightRows(size_t idx, const simpleArray<T>& block);
+
+    /*
+     * Appends all arrays of a trainData block
+     */
+    void append(const trainData<T>& td);
+
+    /*
+     * Compresses the remaining data and writes the final file.
+     * Called by the destructor if not called before.
+     */
+    void close();
+
+    size_t nElements()const;
+
+private:
+    trainDataStreamWriter(const trainDataStreamWriter<T>&);
+    trainDataStreamWriter<T>& operator=(const trainDataStreamWriter<T>&);
+
+    struct arrayStream{
+        arrayStream():spool(0),size(0),totalbytes(0){}
+        std::vector<int> shape;
+        std::vector<int64_t> rowsplits;
+        std::vector<char> pending;
+        FILE * spool;
+        size_t size;
+        size_t totalbytes;
+        std::vector<size_t> chunksizes;
+    };
+
+    struct compressJob{
+        compressJob():array(0),thread(0),compressedbytes(0){}
+        arrayStream * array;
+        std::vector<char> input;
+        std::vector<char> output;
+        std::thread * thread;
+        size_t compressedbytes;
+    };
+
+    void appendRows(std::deque<arrayStream>& arrays, const std::string& prefix,
+            size_t idx, const simpleArray<T>& block);
+    void submit(arrayStream& a);
+    void retireOldest();
+    static void compress(compressJob * job);
+    void writeShapes(const std::deque<arrayStream>& arrays, FILE *& ofile)const;
+    void writeArrays(std::deque<arrayStream>& arrays, FILE *& ofile);
+    void cleanUp();
+
+    std::string filename_;
+    size_t nthreads_;
+    size_t chunkbytes_;
+    bool closed_;
+
+    //deque: jobs keep pointers to the arrays
+    std::deque<arrayStream> feature_arrays_;
+    std::deque<arrayStream> truth_arrays_;
+    std::deque<arrayStream> weight_arrays_;
+
+    std::deque<compressJob *> jobs_;
+};
+
+
+template<class T>
+trainDataStreamWriter<T>::trainDataStreamWriter(const std::string& filename, size_t nthreads,
+        size_t chunkbytes):filename_(filename),nthreads_(nthreads),chunkbytes_(chunkbytes),closed_(false){
+    if(nthreads_<1)
+        nthreads_=1;
+    //chunks smaller than the streaming buffer would depend on each other
+    if(chunkbytes_ <= QLZ_STREAMING_BUFFER)
+        chunkbytes_ = QLZ_STREAMING_BUFFER + 1;
+    if(chunkbytes_ > QUICKLZ_MAXCHUNK)
+        chunkbytes_ = QUICKLZ_MAXCHUNK;
+    chunkbytes_ -= chunkbytes_ % sizeof(T);
+}
+
+template<class T>
+trainDataStreamWriter<T>::~trainDataStreamWriter(){
+    if(closed_)
+        return;
+    try{
+        close();
+    }
+    catch(std::exception& e){
+        std::cout << "trainDataStreamWriter<T>::~trainDataStreamWriter: file "
+                << filename_ << " could not be written: " << e.what() << std::endl;
+    }
+}
+
+template<class T>
+void trainDataStreamWriter<T>::appendFeatureRows(size_t idx, const simpleArray<T>& block){
+    appendRows(feature_arrays_, "f", idx, block);
+}
+
+template<class T>
+void trainDataStreamWriter<T>::appendTruthRows(size_t idx, const simpleArray<T>& block){
+    appendRows(truth_arrays_, "t", idx, block);
+}
+
+template<class T>
+void trainDataStreamWriter<T>::appendWeightRows(size_t idx, const simpleArray<T>& block){
+    appendRows(weight_arrays_, "w", idx, block);
+}
+
+template<class T>
+void trainDataStreamWriter<T>::append(const trainData<T>& td){
+    for(int i=0;i<td.nFeatureArrays();i++)
+        appendFeatureRows(i, td.featureArray(i));
+    for(int i=0;i<td.nTruthArrays();i++)
+        appendTruthRows(i, td.truthArray(i));
+    for(int i=0;i<td.nWeightArrays();i++)
+        appendWeightRows(i, td.weightArray(i));
+}
+
+template<class T>
+size_t trainDataStreamWriter<T>::nElements()const{
+    if(feature_arrays_.size() && feature_arrays_.at(0).shape.size())
+        return feature_arrays_.at(0).shape.at(0);
+    return 0;
+}
+
+template<class T>
+void trainDataStreamWriter<T>::appendRows(std::deque<arrayStream>& arrays, const std::string& prefix,
+        size_t idx, const simpleArray<T>& block){
+    if(closed_)
+        throw std::runtime_error("trainDataStreamWriter<T>::appendRows: writer already closed");
+    if(!block.shape().size())
+        return;
+    if(idx > arrays.size())
+        throw std::out_of_range("trainDataStreamWriter<T>::appendRows: array index out of range");
+
+    if(idx == arrays.size()){//new array, spool is removed right away and vanishes with the handle
+        arrays.push_back(arrayStream());
+        arrayStream& a = arrays.at(idx);
+        std::string spoolname = filename_+".spool_"+prefix+std::to_string(idx);
+        a.spool = fopen(spoolname.data(), "wb+");
+        if(!a.spool)
+            throw std::runtime_error("trainDataStreamWriter<T>::appendRows: could not create "+spoolname);
+        remove(spoolname.data());
+        a.shape = block.shape();
+        a.shape.at(0) = 0;
+        if(block.isRagged()){
+            a.rowsplits.push_back(0);
+            a.shape.at(1) = 0;
+        }
+    }
+    arrayStream& a = arrays.at(idx);
+
+    if(a.shape.size() != block.shape().size() || (a.rowsplits.size()>0) != block.isRagged())
+        throw std::out_of_range("trainDataStreamWriter<T>::appendRows: array format does not match");
+    size_t offset = block.isRagged() ? 2 : 1;
+    for(size_t i=offset;i<a.shape.size();i++)
+        if(a.shape.at(i) != block.shape().at(i))
+            throw std::out_of_range("trainDataStreamWriter<T>::appendRows: all shapes but first axis must match");
+
+    a.shape.at(0) += block.shape().at(0);
+    if(block.isRagged()){
+        a.rowsplits = simpleArray<T>::mergeRowSplits(a.rowsplits, block.rowsplits());
+        a.shape.at(1) = - (int)a.rowsplits.at(a.rowsplits.size()-1);
+    }
+    a.size += block.size();
+
+    //fill chunks
+    const char * src = (const char*)(const void*)block.data();
+    size_t remaining = block.size() * sizeof(T);
+    while(remaining){
+        size_t n = std::min(remaining, chunkbytes_ - a.pending.size());
+        a.pending.insert(a.pending.end(), src, src + n);
+        src += n;
+        remaining -= n;
+        if(a.pending.size() == chunkbytes_)
+            submit(a);
+    }
+}
+
+template<class T>
+void trainDataStreamWriter<T>::submit(arrayStream& a){
+    if(!a.pending.size())
+        return;
+    while(jobs_.size() >= nthreads_)
+        retireOldest();
+    compressJob * job = new compressJob();
+    job->array = &a;
+    job->input.swap(a.pending);
+    a.pending.reserve(chunkbytes_);
+    job->thread = new std::thread(&trainDataStreamWriter<T>::compress, job);
+    jobs_.push_back(job);
+}
+
+template<class T>
+void trainDataStreamWriter<T>::compress(compressJob * job){
+    quicklz<T> qlz;
+    job->output.resize(job->input.size() + 400);
+    job->compressedbytes = qlz.compressChunk(&job->input[0], job->input.size(), &job->output[0]);
+}
+
+/*
+ * jobs are retired in submission order, so the chunks of each array
+ * end up in the spool in the right order
+ */
+template<class T>
+void trainDataStreamWriter<T>::retireOldest(){
+    if(!jobs_.size())
+        return;
+    compressJob * job = jobs_.front();
+    jobs_.pop_front();
+    job->thread->join();
+    delete job->thread;
+    arrayStream& a = *job->array;
+    size_t inbytes = job->input.size();
+    size_t outbytes = job->compressedbytes;
+    std::vector<char> output;
+    output.swap(job->output);
+    delete job;
+
+    if(!outbytes)
+        throw std::runtime_error("trainDataStreamWriter<T>::retireOldest: compression failed");
+    if(a.chunksizes.size() >= 0xff)
+        throw std::runtime_error("trainDataStreamWriter<T>::retireOldest: array too big for the chunk size, use larger chunks");
+    io::writeToFile(&output[0], a.spool, 0, outbytes);
+    a.chunksizes.push_back(outbytes);
+    a.totalbytes += inbytes;
+}
+
+template<class T>
+void trainDataStreamWriter<T>::close(){
+    if(closed_)
+        return;
+    closed_=true;
+    try{
+        for(auto& a: feature_arrays_)
+            submit(a);
+        for(auto& a: truth_arrays_)
+            submit(a);
+        for(auto& a: weight_arrays_)
+            submit(a);
+        while(jobs_.size())
+            retireOldest();
+
+        FILE *ofile = fopen(filename_.data(), "wb");
+        if(!ofile)
+            throw std::runtime_error("trainDataStreamWriter<T>::close: file "+filename_+" could not be opened.");
+        float version = DJCDATAVERSION;
+        io::writeToFile(&version, ofile);
+
+        //shape infos only
+        writeShapes(feature_arrays_, ofile);
+        writeShapes(truth_arrays_, ofile);
+        writeShapes(weight_arrays_, ofile);
+
+        writeArrays(feature_arrays_, ofile);
+        writeArrays(truth_arrays_, ofile);
+        writeArrays(weight_arrays_, ofile);
+        fclose(ofile);
+    }
+    catch(...){
+        cleanUp();
+        throw;
+    }
+    cleanUp();
+}
+
+/*
+ * same layout as trainData<T>::writeNested
+ */
+template<class T>
+void trainDataStreamWriter<T>::writeShapes(const std::deque<arrayStream>& arrays, FILE *& ofile)const{
+    size_t size = arrays.size();
+    io::writeToFile(&size, ofile);
+    for(const auto& a: arrays){
+        size_t nsize = a.shape.size();
+        io::writeToFile(&nsize, ofile);
+        if(nsize==0)
+            continue;
+        io::writeToFile(&(a.shape.at(0)),ofile,nsize);
+    }
+}
+
+/*
+ * same layout as simpleArray<T>::addToFileP
+ */
+template<class T>
+void trainDataStreamWriter<T>::writeArrays(std::deque<arrayStream>& arrays, FILE *& ofile){
+    size_t narrays = arrays.size();
+    io::writeToFile(&narrays, ofile);
+    std::vector<char> buf;
+    for(auto& a: arrays){
+        float version = DJCDATAVERSION;
+        io::writeToFile(&version, ofile);
+        io::writeToFile(&a.size, ofile);
+        size_t ssize = a.shape.size();
+        io::writeToFile(&ssize, ofile);
+        io::writeToFile(&a.shape[0], ofile, a.shape.size());
+
+        size_t rssize = a.rowsplits.size();
+        io::writeToFile(&rssize,  ofile);
+        if(rssize){
+            quicklz<int64_t> iqlz;
+            iqlz.writeCompressed(&a.rowsplits[0],rssize , ofile);
+        }
+
+        quicklz<T> qlz;
+        qlz.writeHeader(a.chunksizes, a.totalbytes, ofile);
+
+        size_t spoolbytes = 0;
+        for(const auto& c: a.chunksizes)
+            spoolbytes += c;
+        fseek(a.spool, 0, SEEK_SET);
+        buf.resize(std::min(spoolbytes, (size_t)64 << 20));
+        while(spoolbytes){
+            size_t n = std::min(spoolbytes, buf.size());
+            io::readFromFile(&buf[0], a.spool, 0, n);
+            io::writeToFile(&buf[0], ofile, 0, n);
+            spoolbytes -= n;
+        }
+    }
+}
+
+template<class T>
+void trainDataStreamWriter<T>::cleanUp(){
+    for(auto job: jobs_){
+        job->thread->join();
+        delete job->thread;
+        delete job;
+    }
+    jobs_.clear();
+    for(auto* arrays: {&feature_arrays_, &truth_arrays_, &weight_arrays_}){
+        for(auto& a: *arrays){
+            if(a.spool)
+                fclose(a.spool);
+            a.spool=0;
+        }
+        arrays->clear();
+    }
+}
+
+}//namespace
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TRAINDATASTREAMWRITER_H_ */
@@ -0,0 +1,54 @@
+/*
+ * treeExpressionPass.h
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#ifndef DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TREEEXPRESSIONPASS_H_
+#define DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TREEEXPRESSIONPASS_H_
+
+#include "TString.h"
+#include "TTree.h"
+#include "friendTreeInjector.h"
+#include <vector>
+#include <functional>
+
+/*
+ * Evaluates a set of TTree::Draw-like expressions in one pass over the
+ * chain of a friendTreeInjector or over a given tree. The entries of a
+ * chain are split in contiguous ranges, one per thread, and each thread
+ * reads through its own copy of the chain. Identical expressions are
+ * evaluated once per entry.
+ * Only scalar expressions are supported (see isScalar).
+ */
+class treeExpressionPass{
+public:
+    /* called for every entry with the values of all expressions, in the order of add */
+    typedef std::function<void(size_t thread, const std::vector<double>& values)> fillFunction;
+
+    /* returns the index of the expression in the values. An empty expression is 1 */
+    size_t add(const TString& expr);
+    size_t size()const{return exprs_.size();}
+
+    void run(const friendTreeInjector& injector, size_t nthreads, const fillFunction& fill)const;
+    /* single-threaded pass over an existing tree, e.g. a columnTree */
+    void run(TTree* t, const fillFunction& fill)const;
+
+    /* false for invalid expressions and expressions with array multiplicity */
+    static bool isScalar(TTree* t, const TString& expr);
+    /* false if the expression can't be compiled for t; empty is valid */
+    static bool isValid(TTree* t, const TString& expr);
+
+    /* splits a Draw expression like "y:x" at the top-level colons, keeps "::" */
+    static std::vector<TString> splitDimensions(const TString& expr);
+
+    static size_t defaultNThreads();
+
+private:
+    void fillRange(TTree* t, Long64_t begin, Long64_t end, size_t thread, const fillFunction& fill)const;
+
+    std::vector<TString> exprs_;
+};
+
+
+#endif /* DJCDEV_DEEPJETCORE_COMPILED_INTERFACE_TREEEXPRESSIONPASS_H_ */
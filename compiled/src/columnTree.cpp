@@ -0,0 +1,76 @@
+/*
+ * columnTree.cpp
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#include "../interface/columnTree.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace p = boost::python;
+namespace np = boost::python::numpy;
+
+columnTree::columnTree():nentries_(0),tree_(0){}
+
+columnTree::~columnTree(){
+    delete tree_;
+}
+
+void columnTree::addColumn(const TString& name, const float* data, size_t nentries, size_t m){
+    if(tree_)
+        throw std::runtime_error("columnTree::addColumn: tree already built");
+    if(names_.size() && nentries!=nentries_)
+        throw std::runtime_error(("columnTree::addColumn: column "+name+" has a different number of entries").Data());
+    if(std::find(names_.begin(),names_.end(),name)!=names_.end())
+        throw std::runtime_error(("columnTree::addColumn: column "+name+" added twice").Data());
+    nentries_=nentries;
+    names_.push_back(name);
+    widths_.push_back(std::max((size_t)1,m));
+    data_.emplace_back(data,data+nentries*widths_.back());
+}
+
+void columnTree::addColumns(const p::dict& columns){
+    p::list keys=columns.keys();
+    for(int i=0;i<p::len(keys);i++){
+        std::string name=p::extract<std::string>(keys[i]);
+        np::ndarray a=p::extract<np::ndarray>(columns[keys[i]]);
+        if(a.get_dtype()!=np::dtype::get_builtin<float>())
+            throw std::runtime_error("columnTree::addColumns: column "+name+" is not float32");
+        if(!(a.get_flags() & np::ndarray::C_CONTIGUOUS))
+            throw std::runtime_error("columnTree::addColumns: column "+name+" is not C-contiguous");
+        if(a.get_nd()<1 || a.get_nd()>2)
+            throw std::runtime_error("columnTree::addColumns: column "+name+" must have shape (n) or (n,m)");
+        size_t m = a.get_nd()>1 ? a.shape(1) : 1;
+        addColumn(name,(const float*)a.get_data(),a.shape(0),m);
+    }
+}
+
+TTree* columnTree::tree(){
+    if(tree_)
+        return tree_;
+    tree_=new TTree("columns","columns");
+    tree_->SetDirectory(0);
+
+    std::vector<std::vector<float> > rows(names_.size());
+    for(size_t i=0;i<names_.size();i++){
+        rows.at(i).resize(widths_.at(i));
+        TString leaf=names_.at(i);
+        if(widths_.at(i)>1){
+            leaf+="[";
+            leaf+=widths_.at(i);
+            leaf+="]";
+        }
+        tree_->Branch(names_.at(i),rows.at(i).data(),leaf+"/F");
+    }
+    for(size_t e=0;e<nentries_;e++){
+        for(size_t i=0;i<names_.size();i++){
+            const float* src=data_.at(i).data()+e*widths_.at(i);
+            std::copy(src,src+widths_.at(i),rows.at(i).begin());
+        }
+        tree_->Fill();
+    }
+    tree_->ResetBranchAddresses();
+    data_.clear();
+    return tree_;
+}
@@ -6,14 +6,49 @@
  */
 
 #include "friendTreeInjector.h"
+#include "c_helper.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TROOT.h"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <unordered_set>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
 
 
 friendTreeInjector::friendTreeInjector(const TString& sourcetreename):
         chain_(0),
         sourcetree_('/'+sourcetreename){}
 
+friendTreeInjector::friendTreeInjector(const friendTreeInjector& rhs):
+        treesandfriends_(rhs.treesandfriends_),
+        friendaliases_(rhs.friendaliases_),
+        originindex_(rhs.originindex_),
+        entries_(rhs.entries_),
+        manifest_(rhs.manifest_),
+        chain_(0),
+        sourcetree_(rhs.sourcetree_){}
+
+friendTreeInjector& friendTreeInjector::operator=(const friendTreeInjector& rhs){
+    if(this==&rhs)
+        return *this;
+    resetChain();
+    treesandfriends_=rhs.treesandfriends_;
+    friendaliases_=rhs.friendaliases_;
+    originindex_=rhs.originindex_;
+    entries_=rhs.entries_;
+    manifest_=rhs.manifest_;
+    sourcetree_=rhs.sourcetree_;
+    return *this;
+}
+
 friendTreeInjector::~friendTreeInjector(){
 	resetChain();
 }
@@ -40,6 +75,7 @@ void friendTreeInjector::addFromFile(const TString& filename, const TString& ali
 			std::vector<TString> orig(1, originroots.at(i));
 			orig.push_back(toinject.at(i));
 			treesandfriends_.push_back(orig);
+			originindex_[(std::string)originroots.at(i)].push_back(i);
 		}
 		return;
 	}
@@ -48,21 +84,32 @@ void friendTreeInjector::addFromFile(const TString& filename, const TString& ali
 		throw std::runtime_error("friendTreeInjector::addFromFile: file lists not same length");
 	}
 
-	//else
-	for( auto& o:treesandfriends_){
-		const TString& orig=o.at(0);
-		for(size_t i=0;i<originroots.size();i++){
-			if(originroots.at(i) == orig){
+	//else, each row gets the first matching friend
+	const size_t ncolumns=treesandfriends_.at(0).size()+1;
+	std::vector<TString> unmatched;
+	for(size_t i=0;i<originroots.size();i++){
+		auto it=originindex_.find((std::string)originroots.at(i));
+		if(it==originindex_.end()){
+			unmatched.push_back(originroots.at(i));
+			continue;
+		}
+		for(const auto& row: it->second){
+			std::vector<TString>& o=treesandfriends_.at(row);
+			if(o.size()<ncolumns)
 				o.push_back(toinject.at(i));
-				//std::cout << toinject.at(i) << std::endl;
-				break;
-			}
 		}
 	}
-
-
-
-
+	for(const auto& o: treesandfriends_)
+		if(o.size()<ncolumns)
+			unmatched.push_back(o.at(0)+" (missing)");
+	if(unmatched.size()){
+		std::stringstream msg;
+		msg << "friendTreeInjector::addFromFile: "<<unmatched.size()<<" origin files in "
+				<<filename<<" don't match the first list:";
+		for(size_t i=0;i<unmatched.size() && i<20;i++)
+			msg << "\n" << unmatched.at(i);
+		throw std::runtime_error(msg.str());
+	}
 }
 
 void friendTreeInjector::showList()const{
@@ -74,13 +121,127 @@ void friendTreeInjector::showList()const{
 	}
 }
 
+static std::string entryKey(const TString& file, const TString& tree){
+	return (std::string)(file+":"+tree);
+}
+
+Long64_t friendTreeInjector::entries(const TString& file, const TString& tree)const{
+	auto it=entries_.find(entryKey(file,tree));
+	if(it==entries_.end())
+		return -1;
+	return it->second;
+}
+
+/* identifies a file version for the manifest, false for remote files */
+static bool fileStamp(const TString& file, Long64_t& size, Long64_t& mtime){
+	struct stat st;
+	if(stat(file.Data(),&st))
+		return false;
+	size=st.st_size;
+	mtime=st.st_mtime;
+	return true;
+}
+
+void friendTreeInjector::countEntries(const std::vector<std::pair<TString,TString> >& trees){
+
+	//from the manifest, if the file did not change since
+	if(manifest_.Length()){
+		std::ifstream in(manifest_.Data());
+		std::string key;
+		Long64_t size,mtime,n;
+		while(in >> key >> size >> mtime >> n){
+			size_t split=key.rfind(':');
+			if(split==std::string::npos)
+				continue;
+			Long64_t cursize,curmtime;
+			if(fileStamp(key.substr(0,split).c_str(),cursize,curmtime) && cursize==size && curmtime==mtime)
+				entries_.emplace(key,n);
+		}
+	}
+
+	std::vector<std::pair<TString,TString> > todo;
+	std::unordered_set<std::string> queued;
+	for(const auto& t: trees)
+		if(entries(t.first,t.second)<0 && queued.insert(entryKey(t.first,t.second)).second)
+			todo.push_back(t);
+	if(todo.empty())
+		return;
+
+	//open and count in parallel, -1: not readable
+	std::vector<Long64_t> counts(todo.size(),-1);
+	size_t nthreads=std::min(todo.size(),(size_t)std::max(1u,std::min(std::thread::hardware_concurrency(),8u)));
+	if(nthreads>1)
+		ROOT::EnableThreadSafety();
+	std::atomic<size_t> next(0);
+	auto worker=[&](){
+		for(size_t i=next++;i<todo.size();i=next++){
+			std::unique_ptr<TFile> f(TFile::Open(todo.at(i).first,"READ"));
+			if(!f || f->IsZombie())
+				continue;
+			TTree* t=(TTree*)f->Get(todo.at(i).second);
+			if(t)
+				counts.at(i)=t->GetEntries();
+		}
+	};
+	std::vector<std::thread> threads;
+	for(size_t i=0;i<nthreads;i++)
+		threads.emplace_back(worker);
+	for(auto& t: threads)
+		t.join();
+
+	bool newentries=false;
+	for(size_t i=0;i<todo.size();i++){
+		if(counts.at(i)<0)
+			continue;
+		entries_[entryKey(todo.at(i).first,todo.at(i).second)]=counts.at(i);
+		newentries=true;
+	}
+
+	if(!newentries || !manifest_.Length())
+		return;
+	//written next to it and renamed, so concurrent jobs never read a partial manifest
+	std::stringstream tmpname;
+	tmpname << manifest_ << ".tmp" << getpid() << '_' << std::this_thread::get_id();
+	const std::string tmp=tmpname.str();
+	{
+		std::ofstream out(tmp);
+		for(const auto& e: entries_){
+			size_t split=e.first.rfind(':');
+			Long64_t size,mtime;
+			if(fileStamp(e.first.substr(0,split).c_str(),size,mtime))
+				out << e.first << ' ' << size << ' ' << mtime << ' ' << e.second << '\n';
+		}
+		if(out.good()){
+			out.close();
+			if(!std::rename(tmp.c_str(),manifest_.Data()))
+				return;
+		}
+	}
+	std::remove(tmp.c_str());
+	std::cerr << "friendTreeInjector: could not write entry manifest "<< manifest_ <<std::endl;
+}
+
 void friendTreeInjector::createChain(){
 
 	if(sourcetree_.Length()<1){
 		throw std::runtime_error("friendTreeInjector::createChain: treename is empty");
 	}
+	if(treesandfriends_.empty()){
+		throw std::runtime_error("friendTreeInjector::createChain: no files added");
+	}
 
 	resetChain();
+
+	const TString sourcetree=sourcetree_(1,sourcetree_.Length()-1);
+	std::vector<std::pair<TString,TString> > trees;
+	for(const auto& row: treesandfriends_){
+		trees.emplace_back(row.at(0),sourcetree);
+		for(size_t j=1;j<row.size();j++)
+			if(row.at(j)!="DUMMY")
+				trees.emplace_back(row.at(j),TString("tree"));
+	}
+	countEntries(trees);
+
 	chain_ = new TChain();
 	friendchains_ = std::vector<TChain*> (treesandfriends_.at(0).size()-1,0);
 	for(size_t i=0;i<treesandfriends_.at(0).size()-1;i++){
@@ -88,17 +249,44 @@ void friendTreeInjector::createChain(){
 	    s+=i;
 	    friendchains_.at(i)=new TChain(s,s);
 	}
+	std::vector<TString> problems;
 	for(size_t i=0;i<treesandfriends_.size();i++){
-	    TString basetree=treesandfriends_.at(i).at(0)+sourcetree_;
-	    //std::cout << basetree << std::endl;
-		chain_->AddFile(basetree);
-		for(size_t j=1;j<treesandfriends_.at(i).size();j++){
-		    TString friendtree=treesandfriends_.at(i).at(j)+"/tree";
-		    //std::cout << j-1<<' '<<friendtree << std::endl;
-		    if(friendtree!="DUMMY/tree")
-		        friendchains_.at(j-1)->AddFile(friendtree);
+		const std::vector<TString>& row=treesandfriends_.at(i);
+		Long64_t n=entries(row.at(0),sourcetree);
+		if(n<0){
+			problems.push_back(row.at(0)+sourcetree_+" could not be read");
+			continue;
+		}
+		chain_->AddFile(row.at(0)+sourcetree_,n);
+		for(size_t j=1;j<row.size();j++){
+			if(row.at(j)=="DUMMY")
+				continue;
+			Long64_t nfriend=entries(row.at(j),"tree");
+			TString problem="";
+			if(nfriend<0)
+				problems.push_back(row.at(j)+"/tree could not be read");
+			else if(nfriend!=n){
+				problem+=row.at(j);
+				problem+="/tree has ";
+				problem+=nfriend;
+				problem+=" entries, ";
+				problem+=row.at(0);
+				problem+=" has ";
+				problem+=n;
+				problems.push_back(problem);
+			}
+			else
+				friendchains_.at(j-1)->AddFile(row.at(j)+"/tree",nfriend);
 		}
 	}
+	if(problems.size()){
+		std::stringstream msg;
+		msg << "friendTreeInjector::createChain: "<<problems.size()<<" trees don't match:";
+		for(size_t i=0;i<problems.size() && i<20;i++)
+			msg << "\n" << problems.at(i);
+		msg << "\nIs is possible that the test data was not converted using --testdatafor?";
+		throw std::out_of_range(msg.str());
+	}
 	for(size_t i=0;i<friendchains_.size();i++){
 		size_t entries=chain_->GetEntries();
 		size_t friendentries=friendchains_.at(i)->GetEntries();
@@ -108,10 +296,18 @@ void friendTreeInjector::createChain(){
 		if(friendentries)
 		    chain_->AddFriend(friendchains_.at(i),friendaliases_.at(i));
 	}
+	//branches are only known from the formulas later, the caches learn them
+	setupTreeCache(chain_);
+	for(auto& f: friendchains_)
+	    setupTreeCache(f);
 
 }
 
 void friendTreeInjector::resetChain(){
-
+    delete chain_;
+    chain_=0;
+    for(auto& f: friendchains_)
+        delete f;
+    friendchains_.clear();
 }
 
@@ -7,6 +7,9 @@
 
 
 #include "../interface/helper.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TEnv.h"
 #include <stdexcept>
 
 #include <iostream>
@@ -33,11 +36,39 @@ bool isApprox(const float& a , const float& b, float eps){
 }
 
 float deltaPhi(const float& a, const float& b){
-    const float pi = 3.14159265358979323846;
-    float delta = (a -b);
-    while (delta >= pi)  delta-= 2* pi;
-    while (delta < -pi)  delta+= 2* pi;
-    return delta;
+    return wrapDeltaPhi(a - b);
+}
+
+static Long64_t treecachesize=-1;
+
+void setTreeReadOptions(Long64_t cachesize, bool prefetch){
+    treecachesize=cachesize;
+    gEnv->SetValue("TFile.AsyncPrefetching", prefetch ? 1 : 0);
+}
+
+TFile * openForReading(const TString& filename){
+    TFile * f = TFile::Open(filename,"READ");
+    if(!f || f->IsZombie()){
+        delete f;
+        throw std::runtime_error("openForReading: file \""+(std::string)filename+"\" could not be opened");
+    }
+    return f;
+}
+
+void setupTreeCache(TTree * tree, const std::vector<TString>& branches){
+    if(branches.size()){
+        tree->SetBranchStatus("*", false);
+        for(const auto& b: branches)
+            tree->SetBranchStatus(b, true);
+    }
+    if(!treecachesize)
+        return;
+    tree->SetCacheSize(treecachesize);
+    if(branches.empty())
+        return;
+    for(const auto& b: branches)
+        tree->AddBranchToCache(b, true);
+    tree->StopCacheLearningPhase();
 }
 
 
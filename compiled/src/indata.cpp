@@ -8,6 +8,12 @@
 #include "../interface/indata.h"
 
 #include "TLeaf.h"
+#include "TMath.h"
+#include <algorithm>
+#ifdef INDATA_BULKIO
+#include "TBufferFile.h"
+#include "Bytes.h"
+#endif
 
 namespace __hidden{
 
@@ -21,6 +27,14 @@ void indata::setSize(size_t i){
     tbranches.resize(i,0);
     buffer.resize(i,0);
     buffervec.resize(i,0);
+    leaves_.resize(i,0);
+    bufferstore_.resize(i);
+    vecstore_.resize(i);
+    columns_.resize(i);
+    coloffsets_.resize(i);
+    bulk_.resize(i,false);
+    bulkvals_.resize(i);
+    bulkfirst_.resize(i,0);
 }
 
 
@@ -43,11 +57,24 @@ void indata::createFrom(std::vector<TString>  s_branches,
     }
 }
 
+indata::indata(const indata& rhs):indata(){
+    *this = rhs;
+}
+
+indata& indata::operator=(const indata& rhs){
+    if(this == &rhs)
+        return *this;
+    norms = rhs.norms;
+    means = rhs.means;
+    branches = rhs.branches;
+    max = rhs.max;
+    offset_ = rhs.offset_;
+    mask_ = rhs.mask_;
+    clearBuffers();
+    return *this;
+}
+
 indata::~indata(){
-    //	for(auto& b:buffer)
-    //		if(b) delete b;
-    //	for(auto& b:branches)
-    //		if(b) delete b;
 }
 
 float indata::getData(const size_t& b,const size_t& i){
@@ -81,15 +108,67 @@ void indata::getEntry(size_t entry){
         if(mask_ != (int)i){
             tbranches.at(i)->GetEntry(entry);
             if (buffervec.at(i)){
-                for (unsigned k=0; k<MAXBRANCHLENGTH; ++k){
-                    buffer.at(i)[k] = (k < buffervec.at(i)->size() ? buffervec.at(i)->at(k) : 0);
-                }
+                const std::vector<float>& v = *buffervec.at(i);
+                const size_t bufsize = bufferstore_.at(i).size();
+                const size_t n = std::min(v.size(), bufsize);
+                std::copy(v.begin(), v.begin()+n, buffer.at(i));
+                std::fill(buffer.at(i)+n, buffer.at(i)+bufsize, 0);
             }
         }
 
     }
 }
 
+float indata::getPadding(const size_t& b) {
+    return paddingValue(buffervec.at(b), means.at(b), norms.at(b));
+}
+
+float indata::paddingValue(bool isvector, float mean, float norm) {
+    if(!doscaling)
+        return 0;
+    //vector branches are padded with 0 before scaling in getEntry
+    if(isvector || meanPadding)
+        return -mean / norm;
+    return 0;
+}
+
+void indata::readRange(Long64_t first, Long64_t last){
+    if(last < first)
+        throw std::out_of_range("indata::readRange: invalid range");
+    colfirst_ = first;
+    const size_t nentries = last - first;
+
+    for(size_t i=0;i<branches.size();i++){
+        auto& col = columns_.at(i);
+        auto& offs = coloffsets_.at(i);
+        col.clear();
+        offs.assign(1,0);
+        if(mask_ == (int)i){
+            offs.resize(nentries+1, 0);
+            continue;
+        }
+        if(bulk_.at(i) && readBulk(i, first, last))
+            continue;
+
+        //generic path, still column by column to stay within the same baskets
+        offs.reserve(nentries+1);
+        for(Long64_t e=first;e<last;e++){
+            tbranches.at(i)->GetEntry(e);
+            if(buffervec.at(i)){
+                const std::vector<float>& v = *buffervec.at(i);
+                col.insert(col.end(), v.begin(), v.end());
+            }
+            else{
+                size_t len = leaves_.at(i)->GetLen();
+                if(len > bufferstore_.at(i).size())
+                    len = bufferstore_.at(i).size();
+                col.insert(col.end(), buffer.at(i), buffer.at(i)+len);
+            }
+            offs.push_back(col.size());
+        }
+    }
+}
+
 bool indata::isVector()const{
 	for(const auto& v:buffervec){
 		if(!v)return false;
@@ -98,31 +177,54 @@ bool indata::isVector()const{
 }
 
 void indata::setup(TTree* tree, const TString& treename){
-    if(MAXBRANCHLENGTH<max)
-        throw std::runtime_error("indata::setup: max larger than buffer! (clean up here needed: TBI)");
     if(! tree)
     	throw std::runtime_error("indata::setup: tree \""+(std::string)treename +"\" is not valid! (NULL)");
     if(tree->IsZombie())
     	throw std::runtime_error("indata::setup: tree \""+(std::string)treename +"\" is not valid! (Zombie)");
 
-    for(auto& b: buffer)
-        b=new float[MAXBRANCHLENGTH];
+    clearBuffers();
+    //at least one element so that there is always a valid address
+    const size_t minsize = max > 0 ? max : 1;
 
     for(size_t i=0;i<branches.size();i++){
         if(mask_ != (int)i){
-            tbranches.at(i)=new TBranch();
-
             int ret=0;
 
-            auto leaf = (TLeaf*)tree->GetBranch(branches.at(i))->GetListOfLeaves()->At(0);
+            TBranch * branch = tree->GetBranch(branches.at(i));
+            if(!branch)
+                handleReturns(-5, branches.at(i));
+            auto leaf = (TLeaf*)branch->GetListOfLeaves()->At(0);
+            leaves_.at(i) = leaf;
             if (TString(leaf->GetTypeName()).Contains("vector<float>")){
-                buffervec.at(i) = new std::vector<float>;
+                //only the first max elements are copied to the buffer
+                bufferstore_.at(i).assign(minsize, 0);
+                buffer.at(i) = bufferstore_.at(i).data();
+                vecstore_.at(i).reset(new std::vector<float>);
+                buffervec.at(i) = vecstore_.at(i).get();
                 ret=tree->SetBranchAddress(branches.at(i), &buffervec.at(i), &tbranches.at(i));
             }else{
+                //root writes the full branch to the buffer
+                size_t len = leaf->GetLenStatic();
+                if(leaf->GetLeafCount())
+                    len *= leaf->GetLeafCount()->GetMaximum();
+                bufferstore_.at(i).assign(std::max(len, minsize), 0);
+                buffer.at(i) = bufferstore_.at(i).data();
                 buffervec.at(i)=0;
                 ret=tree->SetBranchAddress(branches.at(i),buffer.at(i),&tbranches.at(i));
             }
             handleReturns(ret, branches.at(i));
+
+#ifdef INDATA_BULKIO
+            TBranch * br = tbranches.at(i);
+            bulk_.at(i) = !buffervec.at(i) && br->GetListOfLeaves()->GetEntries() == 1
+                    && TString(leaf->GetTypeName()) == "Float_t"
+                    && !leaf->GetLeafCount() && leaf->GetLenStatic() == 1
+                    && br->GetBulkRead().SupportsBulkRead();
+#endif
+        }
+        else{//not read, but still zeroed
+            bufferstore_.at(i).assign(minsize, 0);
+            buffer.at(i) = bufferstore_.at(i).data();
         }
     }
 }
@@ -131,6 +233,66 @@ void indata::setup(TTree* tree, const TString& treename){
 
 ///private
 
+void indata::clearBuffers(){
+    const size_t n = branches.size();
+    buffer.assign(n,0);
+    buffervec.assign(n,0);
+    tbranches.assign(n,0);
+    leaves_.assign(n,0);
+    bufferstore_.assign(n,std::vector<float>());
+    vecstore_.clear();
+    vecstore_.resize(n);
+    columns_.assign(n,std::vector<float>());
+    coloffsets_.assign(n,std::vector<size_t>());
+    bulk_.assign(n,false);
+    bulkvals_.assign(n,std::vector<float>());
+    bulkfirst_.assign(n,0);
+}
+
+bool indata::readBulk(size_t b, Long64_t first, Long64_t last){
+#ifdef INDATA_BULKIO
+    TBranch * br = tbranches.at(b);
+    auto& vals = bulkvals_.at(b);
+    Long64_t& valsfirst = bulkfirst_.at(b);
+
+    //the bulk API only reads from the start of a basket
+    if(vals.empty() || first < valsfirst || first > valsfirst + (Long64_t)vals.size()){
+        vals.clear();
+        Long64_t ib = TMath::BinarySearch((Long64_t)br->GetWriteBasket()+1, br->GetBasketEntry(), first);
+        valsfirst = ib < 0 ? 0 : br->GetBasketEntry()[ib];
+    }
+
+    TBufferFile rawbuf(TBuffer::kWrite, 32*1024);
+    while(valsfirst + (Long64_t)vals.size() < last){
+        Int_t nread = br->GetBulkRead().GetEntriesSerialized(valsfirst + vals.size(), rawbuf);
+        if(nread <= 0){//give up on this branch, generic path from now on
+            bulk_.at(b) = false;
+            vals.clear();
+            return false;
+        }
+        char * raw = rawbuf.GetCurrent();
+        size_t start = vals.size();
+        vals.resize(start + nread);
+        for(Int_t k=0;k<nread;k++)
+            frombuf(raw, &vals[start+k]);//big endian on disk
+    }
+
+    auto& col = columns_.at(b);
+    auto& offs = coloffsets_.at(b);
+    const size_t nentries = last - first;
+    col.assign(vals.begin() + (first - valsfirst), vals.begin() + (last - valsfirst));
+    offs.resize(nentries+1);
+    for(size_t e=0;e<=nentries;e++)
+        offs[e] = e;
+    //keep what was decoded beyond the range for the next one
+    vals.erase(vals.begin(), vals.begin() + (last - valsfirst));
+    valsfirst = last;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void indata::handleReturns(int ret, const TString& branchname)const{
 	if(ret == -2 || ret == -1){
 		std::cout << "indata: Class type given for branch " << branchname
@@ -25,6 +25,8 @@
 #include "rocCurve.h"
 #include <iostream>
 #include "TCanvas.h"
+#include <algorithm>
+#include <thread>
 
 size_t rocCurve::nrocsCounter=0;
 
@@ -76,34 +78,31 @@ rocCurve::~rocCurve(){
 }
 
 
-//now done in a simple tree-Draw way - if optmisation needed: switch to putting rocs in a loop (TBI)
-void rocCurve::process(TChain *c,std::ostream& out){
-
-
-
+void rocCurve::expressions(TString& probstr, TString& allcuts, TString& vetostr,
+        TString& allinvalid_truth, TString& allinvalid_veto)const{
 
     TString truthstr="";
     for(const auto& s:truths_)
         truthstr+=s+"+";
     truthstr.Remove(truthstr.Length()-1);
 
-    TString vetostr="";
+    vetostr="";
     for(const auto& s:vetotruths_)
         vetostr+=s+"+";
     vetostr.Remove(vetostr.Length()-1);
 
-    TString probstr="";
+    probstr="";
     for(const auto& s:probabilities_)
         probstr+=s+"+";
     probstr.Remove(probstr.Length()-1);
 
-    TString allcuts=truthstr;
-    TString allinvalid_truth=makeinvalidif_;
+    allcuts=truthstr;
+    allinvalid_truth=makeinvalidif_;
     if(allinvalid_truth.Length()<1){
         allinvalid_truth=probstr+"<-10000"; //false
     }
 
-    TString allinvalid_veto=allinvalid_truth+"&&"+vetostr;
+    allinvalid_veto=allinvalid_truth+"&&"+vetostr;
     allinvalid_truth+="&&"+truthstr;
 
     if(cuts_.Length()){
@@ -119,7 +118,11 @@ void rocCurve::process(TChain *c,std::ostream& out){
         allinvalid_truth=allinvalid_truth+"&&"+cuts_;
         allinvalid_veto+="&&"+cuts_;
     }
+}
 
+void rocCurve::bookHistos(){
+
+    integrator_.clear();
 
     TString nrcc="";
     nrcc+=nrocsCounter;
@@ -127,8 +130,6 @@ void rocCurve::process(TChain *c,std::ostream& out){
     //the bins should be log scale towards high probabilities if nbins>200
     //map over modified softsign
 
-
-    TCanvas cv;//just a dummy
     if(nbins_<201){
         probh_=TH1D("prob"+nrcc,"prob"+nrcc,nbins_,0,1.+0.00001);
         vetoh_=TH1D("veto"+nrcc,"veto"+nrcc,nbins_,0,1.+0.00001);
@@ -149,12 +150,33 @@ void rocCurve::process(TChain *c,std::ostream& out){
         invalidate_veto_=TH1D("invalid_veto"+nrcc,"invalid_veto"+nrcc,nbins_,&binning.at(0));
 
     }
+}
+
+void rocCurve::process(TTree *c,std::ostream& out){
+
+    TString probstr,allcuts,vetostr,allinvalid_truth,allinvalid_veto;
+    expressions(probstr,allcuts,vetostr,allinvalid_truth,allinvalid_veto);
+
+    TString nrcc="";
+    nrcc+=nrocsCounter;
+
+    TCanvas cv;//just a dummy
+    bookHistos();
 
     c->Draw(probstr+">>prob"+nrcc,allcuts);//probcuts);
     c->Draw(probstr+">>veto"+nrcc,vetostr);
     c->Draw(probstr+">>invalid"+nrcc,allinvalid_truth);
     c->Draw(probstr+">>invalid_veto"+nrcc,allinvalid_veto);
 
+    finish(out);
+}
+
+void rocCurve::finish(std::ostream& out){
+
+    TString nrcc="";
+    nrcc+=nrocsCounter;
+
+    TCanvas cv;//just a dummy
 
     //remove from mem list
     probh_.SetDirectory(0);
@@ -167,12 +189,6 @@ void rocCurve::process(TChain *c,std::ostream& out){
     invalidate_.SetName("invalidate_"+nrcc);
     invalidate_veto_.SetName("invalidate_veto_"+nrcc);
 
-    std::vector<double> p(nbins_),v(nbins_);
-
-    double probintegral=probh_.Integral(0,nbins_);
-    double vetointegral=vetoh_.Integral(0,nbins_);
-    // double invalidintegral=invalid.Integral(0,nbins_);
-
     probh_.Add(&invalidate_,-1.);
     vetoh_.Add(&invalidate_veto_,-1.);
 
@@ -180,9 +196,27 @@ void rocCurve::process(TChain *c,std::ostream& out){
         if(probh_.GetBinContent(i)<0)probh_.SetBinContent(i,0);//just safety measure
     }
 
-    for(size_t i=0;i<nbins_;i++) {
-        p[i] = probh_.Integral(i,nbins_)/(probintegral);
-        v[i] = yscale_*vetoh_.Integral(i,nbins_)/vetointegral;
+    //process() only has the histograms: use the bins as points
+    if(integrator_.empty()){
+        for(int i=0;i<=probh_.GetNbinsX()+1;i++){
+            integrator_.add(probh_.GetBinCenter(i), probh_.GetBinContent(i), vetoh_.GetBinContent(i));
+            integrator_.addNorm(invalidate_.GetBinContent(i), invalidate_veto_.GetBinContent(i));
+        }
+    }
+    integrator_.compute(std::max(1u,std::thread::hardware_concurrency()));
+
+    const std::vector<double>& effs=integrator_.efficiencies();
+    const std::vector<double>& misids=integrator_.misids();
+
+    //thin out for drawing, the working points below use the full curve
+    std::vector<double> p,v;
+    for(size_t i=0;i<effs.size();i++){
+        double misid=yscale_*misids[i];
+        if(p.size() && i+1<effs.size() && effs[i]-p.back()<1e-4
+                && (misid<=v.back()*1.001 || misid<1e-7))
+            continue;
+        p.push_back(effs[i]);
+        v.push_back(misid);
     }
     TString compatname=name_;
     compatname.ReplaceAll(" ","_");
@@ -190,7 +224,7 @@ void rocCurve::process(TChain *c,std::ostream& out){
     compatname.ReplaceAll(":","_");
     compatname.ReplaceAll("!","_");
 
-    roc_=TGraph(nbins_,&p.at(0),&v.at(0));
+    roc_=TGraph(p.size(),&p.at(0),&v.at(0));
     roc_.SetName(compatname+nrcc);
     roc_.SetTitle(name_+nrcc);
     roc_.Draw("L");//necessary for some weird root reason
@@ -198,30 +232,16 @@ void rocCurve::process(TChain *c,std::ostream& out){
 
     out << "eff @ misid @ discr value\n\n";
     std::vector<double> misidset=loglist(yscale_*0.00001,yscale_*1,yscale_*100);
-    int count=0;
-    double integral=0;
-    for(float eff=0;eff<1;eff+=0.00001){
-
-        float misid=roc_.Eval(eff);
-        integral+=misid*0.00001;
-        if(misid>misidset[count]){
-            out << eff <<"@"<< misid;
-            count++;
-            //search for closest bin
-            if(fullanalysis_){
-                for(size_t i=0;i<nbins_-1;i++) {
-                    double integra=probh_.Integral(i,nbins_)/(probintegral);
-                    double integrb=probh_.Integral(i+1,nbins_)/(probintegral);
-                    if(eff>integrb && eff<integra){
-                        out<< "@"<<probh_.GetBinCenter(i);
-                    }
-                }
-            }
-            out <<std::endl;
-        }
-
+    for(const auto& misid: misidset){
+        if(misid/yscale_ > misids.back())
+            break;
+        rocIntegrator::workingPoint wp=integrator_.atMisid(misid/yscale_);
+        out << wp.eff <<"@"<< misid;
+        if(fullanalysis_)
+            out<< "@"<<wp.score;
+        out <<std::endl;
     }
-    out << "Area under ROC: "<< integral<<std::endl;
+    out << "Area under ROC: "<< yscale_*integrator_.area()<<std::endl;
     roc_.SetLineColor(linecol_);
     roc_.SetLineStyle(linestyle_);
     roc_.SetLineWidth(linewidth_);
@@ -16,7 +16,10 @@
 #include "TFile.h"
 #include "TLegendEntry.h"
 #include "TLatex.h"
+#include "treeExpressionPass.h"
 #include <fstream>
+#include <memory>
+#include <stdexcept>
 
 //void rocCurveCollection::addROC(const TString& name, const TString& probability, const TString& truth,
 //        const TString& vetotruth, int linecol, const TString& cuts, int linestyle){
@@ -44,7 +47,7 @@ void rocCurveCollection::addROC(const TString& name, const TString& probability,
 }
 
 
-void rocCurveCollection::printRocs(TChain* c, const TString& outpdf,
+void rocCurveCollection::printRocs(TTree* c, const TString& outpdf,
         const TString&outfile, TCanvas* cv, TFile * f, std::vector<TChain*>* chainvec,const double xmin_in,
 		TString experimentlabel,TString lumilabel,TString prelimlabel){
 
@@ -59,19 +62,41 @@ void rocCurveCollection::printRocs(TChain* c, const TString& outpdf,
     }
     size_t count=0;
     float maxyscale=0.;
-    std::vector<TH1D*> probhistos,vetohistos,invalidhistos,invalidvetohistos;
+
+    //all curves on the same chain are filled in one pass
+    std::vector<std::unique_ptr<std::ofstream> > outtxts;
+    std::vector<TTree*> chains;
+    std::vector<std::vector<size_t> > chaincurves;
     for(size_t i=0;i<roccurves_.size();i++){
         rocCurve& rc=roccurves_.at(i);
-        std::ofstream outtxt((filename+"_"+rc.compatName()+".txt").Data());
+        outtxts.emplace_back(new std::ofstream((filename+"_"+rc.compatName()+".txt").Data()));
         rc.setNBins(nbins_);
-        if(c)
-            rc.process(c,outtxt);
-        else
-            rc.process(chainvec->at(i),outtxt);
+        rc.setMaxPoints(maxrocpoints_);
+        TTree* curvechain = c ? c : chainvec->at(i);
+        size_t ichain=0;
+        for(;ichain<chains.size();ichain++)
+            if(chains.at(ichain)==curvechain)
+                break;
+        if(ichain==chains.size()){
+            chains.push_back(curvechain);
+            chaincurves.push_back(std::vector<size_t>());
+        }
+        chaincurves.at(ichain).push_back(i);
+    }
+    for(size_t ichain=0;ichain<chains.size();ichain++){
+        std::vector<std::ostream*> outs;
+        for(const auto& i: chaincurves.at(ichain))
+            outs.push_back(outtxts.at(i).get());
+        fillRocs(chains.at(ichain), chaincurves.at(ichain), outs);
+    }
+    outtxts.clear();
+
+    std::vector<TH1D*> probhistos,vetohistos,invalidhistos,invalidvetohistos;
+    for(size_t i=0;i<roccurves_.size();i++){
+        rocCurve& rc=roccurves_.at(i);
         TString tempname="tmph_";
         tempname+=count;
         count++;
-        outtxt.close();
 
         TH1D* ha=(TH1D*)rc.getProbHisto()->Clone(tempname);
         probhistos.push_back(ha);
@@ -278,3 +303,52 @@ void rocCurveCollection::printRocs(TChain* c, const TString& outpdf,
 
 //int linewidth_;
 //std::vector<rocCurve> roccurves_;
+
+void rocCurveCollection::fillRocs(TTree* c, const std::vector<size_t>& curves, std::vector<std::ostream*>& outs){
+
+    if(c->LoadTree(0)<0){//nothing to fill, but same output as with Draw
+        for(size_t i=0;i<curves.size();i++){
+            roccurves_.at(curves.at(i)).bookHistos();
+            roccurves_.at(curves.at(i)).finish(*outs.at(i));
+        }
+        return;
+    }
+
+    //per curve the index of prob and the selections in the pass
+    treeExpressionPass pass;
+    std::vector<std::vector<size_t> > curveexprs(curves.size());
+    std::vector<size_t> onepass;
+    for(size_t i=0;i<curves.size();i++){
+        rocCurve& rc=roccurves_.at(curves.at(i));
+        TString prob,probsel,vetosel,invalidsel,invalidvetosel;
+        rc.expressions(prob,probsel,vetosel,invalidsel,invalidvetosel);
+        const std::vector<TString> exprs={prob,probsel,vetosel,invalidsel,invalidvetosel};
+        bool scalar=prob.Length()>0;
+        for(const auto& e: exprs){
+            if(!treeExpressionPass::isValid(c,e))
+                throw std::runtime_error(("rocCurveCollection::fillRocs: invalid expression "+e).Data());
+            scalar = scalar && treeExpressionPass::isScalar(c,e);
+        }
+        if(!scalar){//arrays are filled per instance, leave that to Draw
+            rc.process(c,*outs.at(i));
+            continue;
+        }
+        for(const auto& e: exprs)
+            curveexprs.at(i).push_back(pass.add(e));
+        rc.bookHistos();
+        onepass.push_back(i);
+    }
+
+    if(onepass.size()){
+        pass.run(c,[&](size_t, const std::vector<double>& values){
+            for(const auto& i: onepass){
+                const std::vector<size_t>& idxs=curveexprs.at(i);
+                roccurves_.at(curves.at(i)).fill(values.at(idxs.at(0)),values.at(idxs.at(1)),
+                        values.at(idxs.at(2)),values.at(idxs.at(3)),values.at(idxs.at(4)));
+            }
+        });
+    }
+
+    for(const auto& i: onepass)
+        roccurves_.at(curves.at(i)).finish(*outs.at(i));
+}
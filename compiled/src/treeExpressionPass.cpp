@@ -0,0 +1,160 @@
+/*
+ * treeExpressionPass.cpp
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+#include "treeExpressionPass.h"
+#include "TTreeFormula.h"
+#include "TChain.h"
+#include "TROOT.h"
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+/* formula compilation goes through the interpreter, one at a time */
+static std::mutex formulamutex;
+
+size_t treeExpressionPass::add(const TString& expr){
+    TString e = expr.Length() ? expr : TString("1");
+    for(size_t i=0;i<exprs_.size();i++)
+        if(exprs_.at(i)==e)
+            return i;
+    exprs_.push_back(e);
+    return exprs_.size()-1;
+}
+
+bool treeExpressionPass::isScalar(TTree* t, const TString& expr){
+    if(!expr.Length())
+        return true;
+    std::lock_guard<std::mutex> lock(formulamutex);
+    TTreeFormula f("isScalar",expr,t);
+    return f.GetNdim() && !f.GetMultiplicity();
+}
+
+bool treeExpressionPass::isValid(TTree* t, const TString& expr){
+    if(!expr.Length())
+        return true;
+    std::lock_guard<std::mutex> lock(formulamutex);
+    TTreeFormula f("isValid",expr,t);
+    return f.GetNdim();
+}
+
+std::vector<TString> treeExpressionPass::splitDimensions(const TString& expr){
+    std::vector<TString> out;
+    const char* s=expr.Data();
+    int depth=0;
+    int start=0;
+    for(int i=0;i<expr.Length();i++){
+        if(s[i]=='(' || s[i]=='[') depth++;
+        else if(s[i]==')' || s[i]==']') depth--;
+        else if(s[i]==':' && !depth){
+            if(s[i+1]==':'){//scope, e.g. TMath::Abs
+                i++;
+                continue;
+            }
+            out.push_back(expr(start,i-start));
+            start=i+1;
+        }
+    }
+    out.push_back(expr(start,expr.Length()-start));
+    return out;
+}
+
+size_t treeExpressionPass::defaultNThreads(){
+    size_t n=std::thread::hardware_concurrency();
+    return std::max((size_t)1,std::min(n,(size_t)8));
+}
+
+void treeExpressionPass::run(const friendTreeInjector& injector, size_t nthreads, const fillFunction& fill)const{
+
+    if(nthreads<1)
+        nthreads=1;
+    if(nthreads>1)
+        ROOT::EnableThreadSafety();
+
+    std::vector<friendTreeInjector> injectors(nthreads,injector);
+    std::vector<std::exception_ptr> errors(nthreads);
+    Long64_t nentries=-1;
+    std::mutex entriesmutex;
+
+    auto worker=[&](size_t t){
+        try{
+            friendTreeInjector& inj=injectors.at(t);
+            inj.createChain();
+            TChain* c=inj.getChain();
+            Long64_t n=c->GetEntries();
+            {
+                std::lock_guard<std::mutex> lock(entriesmutex);
+                if(nentries<0)
+                    nentries=n;
+                else if(nentries!=n)
+                    throw std::runtime_error("treeExpressionPass::run: chains differ between threads");
+            }
+            Long64_t begin=n*t/nthreads, end=n*(t+1)/nthreads;
+            if(begin>=end)
+                return;
+
+            fillRange(c,begin,end,t,fill);
+        }
+        catch(...){
+            errors.at(t)=std::current_exception();
+        }
+    };
+
+    if(nthreads==1){
+        worker(0);
+    }
+    else{
+        std::vector<std::thread> threads;
+        for(size_t t=0;t<nthreads;t++)
+            threads.emplace_back(worker,t);
+        for(auto& t: threads)
+            t.join();
+    }
+    for(const auto& e: errors)
+        if(e)
+            std::rethrow_exception(e);
+}
+
+void treeExpressionPass::run(TTree* t, const fillFunction& fill)const{
+    fillRange(t,0,t->GetEntries(),0,fill);
+}
+
+void treeExpressionPass::fillRange(TTree* c, Long64_t begin, Long64_t end, size_t t, const fillFunction& fill)const{
+
+    if(c->LoadTree(begin)<0)
+        return;
+
+    std::vector<std::unique_ptr<TTreeFormula> > formulas;
+    {
+        std::lock_guard<std::mutex> lock(formulamutex);
+        for(size_t i=0;i<exprs_.size();i++){
+            TString fname="exprpass_";
+            fname+=i;
+            formulas.emplace_back(new TTreeFormula(fname,exprs_.at(i),c));
+            if(!formulas.back()->GetNdim())
+                throw std::runtime_error(("treeExpressionPass::run: invalid expression "+exprs_.at(i)).Data());
+        }
+    }
+
+    std::vector<double> values(formulas.size(),0);
+    int treenumber=-1;
+    for(Long64_t entry=begin;entry<end;entry++){
+        if(c->LoadTree(entry)<0)
+            break;
+        if(c->GetTreeNumber()!=treenumber){
+            treenumber=c->GetTreeNumber();
+            for(auto& f: formulas)
+                f->UpdateFormulaLeaves();
+        }
+        for(size_t k=0;k<formulas.size();k++){
+            formulas.at(k)->GetNdata();
+            values.at(k)=formulas.at(k)->EvalInstance(0);
+        }
+        fill(t,values);
+    }
+}
@@ -0,0 +1,101 @@
+#include "../interface/simpleArray.h"
+#include "../interface/trainData.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace djc;
+
+/*
+ * appendMany(arrs, nthreads) gives the same result as appending the arrays
+ * one by one, for dense and ragged arrays and any number of threads.
+ * The arrays are large enough that up to 8 threads copy.
+ */
+
+static simpleArray<float> makeDense(size_t nentries){
+    simpleArray<float> a({(int)nentries,16,4});
+    for(size_t i=0;i<a.size();i++)
+        a.data()[i]=rand()%1000;
+    return a;
+}
+
+static simpleArray<float> makeRagged(size_t nentries){
+    std::vector<int64_t> rowsplits(1,0);
+    for(size_t i=0;i<nentries;i++)
+        rowsplits.push_back(rowsplits.back() + rand()%40);//also empty entries
+    simpleArray<float> a({(int)nentries,-1,3},rowsplits);
+    for(size_t i=0;i<a.size();i++)
+        a.data()[i]=rand()%1000;
+    return a;
+}
+
+int main(){
+
+    srand(5);
+    size_t nfailed=0;
+    auto check=[&nfailed](const std::string& what, bool ok){
+        if(!ok){
+            std::cout << what << " failed" << std::endl;
+            nfailed++;
+        }
+    };
+
+    for(bool ragged: {false, true}){
+        const std::string type = ragged ? "ragged " : "dense ";
+        std::vector<simpleArray<float> > arrs;
+        for(size_t n: {20000, 1, 35000, 0, 17000, 50000, 3})
+            arrs.push_back(ragged ? makeRagged(n) : makeDense(n));
+        std::vector<simpleArray<float> > withempty = arrs;
+        withempty.push_back(simpleArray<float>());//no shape, ignored by appendMany
+
+        simpleArray<float> start = ragged ? makeRagged(1000) : makeDense(1000);
+        start.split(300);//appends behind an offset
+
+        simpleArray<float> expected = start;
+        for(const auto& a: arrs)
+            expected.append(a);
+
+        for(size_t nthreads: {0, 1, 2, 3, 8}){
+            const std::string what = type+std::to_string(nthreads)+" threads";
+
+            simpleArray<float> many = start;
+            many.appendMany(withempty, nthreads);
+            check(what, many==expected);
+
+            simpleArray<float> fromempty, seq;
+            fromempty.appendMany(arrs, nthreads);
+            for(const auto& a: arrs)
+                seq.append(a);
+            check(what+" from empty", fromempty==seq);
+
+            //the array itself in the list
+            simpleArray<float> self = arrs.at(2), selfseq = arrs.at(2);
+            self.appendMany(std::vector<const simpleArray<float>* >({&self, &arrs.at(0), &self}), nthreads);
+            simpleArray<float> before = selfseq;
+            selfseq.append(before);
+            selfseq.append(arrs.at(0));
+            selfseq.append(before);
+            check(what+" self", self==selfseq);
+        }
+
+        //trainData
+        std::vector<trainData<float> > tds(arrs.size());
+        trainData<float> tdexpected, tdmany;
+        for(size_t i=0;i<tds.size();i++){
+            simpleArray<float> feat = arrs.at(i), truth = makeDense(arrs.at(i).getFirstDimension());
+            tds.at(i).storeFeatureArray(feat);
+            tds.at(i).storeTruthArray(truth);
+            tdexpected.append(tds.at(i));
+        }
+        tdmany.appendMany(tds, 3);
+        check(type+"trainData", tdmany.featureArray(0)==tdexpected.featureArray(0)
+                && tdmany.truthArray(0)==tdexpected.truthArray(0));
+    }
+
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
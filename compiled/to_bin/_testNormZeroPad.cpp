@@ -0,0 +1,51 @@
+#include "../interface/normZeroPad.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+/*
+ * compares the vectorised mean-norm-zero-pad kernel to the scalar reference
+ */
+int main(){
+
+    using namespace __hidden;
+
+    srand(1);
+    std::vector<float> src(200);
+    for(auto& s: src)
+        s = (float)rand()/RAND_MAX * 200. - 100.;
+
+    size_t nfailed=0;
+    for(size_t stride: {1, 3}){
+        for(size_t max: {0, 1, 3, 7, 8, 9, 31, 64, 100}){
+            for(size_t n: {0, 1, 5, 8, 17, 64, 150}){
+                std::vector<float> fast(max*stride, -999), ref(max*stride, -999);
+                normZeroPad(&src[0], n, 2.5, 7.3, -0.34, fast.data(), max, stride);
+                normZeroPadReference(&src[0], std::min(n, max), 2.5, 7.3, -0.34, ref.data(), max, stride);
+                for(size_t i=0;i<fast.size();i++){
+                    if(std::fabs(fast[i]-ref[i]) > 1e-6 * std::fabs(ref[i]) + 1e-7){
+                        std::cout << "mismatch stride " << stride << " max " << max << " n " << n
+                                << " at " << i << ": " << fast[i] << " vs " << ref[i] << std::endl;
+                        nfailed++;
+                    }
+                }
+            }
+        }
+    }
+    //no scaling needs to be exact
+    std::vector<float> fast(150), ref(150);
+    normZeroPad(&src[0], 120, 0, 1, 0, fast.data(), 150);
+    normZeroPadReference(&src[0], 120, 0, 1, 0, ref.data(), 150);
+    if(fast != ref){
+        std::cout << "mismatch without scaling" << std::endl;
+        nfailed++;
+    }
+
+    if(nfailed){
+        std::cout << nfailed << " mismatches" << std::endl;
+        return 1;
+    }
+    std::cout << "passed" << std::endl;
+    return 0;
+}
@@ -31,6 +31,81 @@ void coutarray(const simpleArray<float> & farr){
     std::cout << std::endl;
 }
 
+static simpleArray<float> countingRagged(const std::vector<int64_t>& rowsplits){
+    simpleArray<float> a({(int)rowsplits.size()-1,-1,2},rowsplits);
+    for(size_t i=0;i<a.size();i++)
+        a.data()[i]=i;
+    return a;
+}
+
+static bool counts(const simpleArray<float>& a, float first, size_t n){
+    if(a.size()!=n) return false;
+    for(size_t i=0;i<n;i++)
+        if(a.data()[i]!=first+i) return false;
+    return true;
+}
+
+/*
+ * split keeps the remaining part in the same buffer behind an offset,
+ * checks the ragged operations that have to respect that offset
+ */
+static size_t testOffsetArrays(){
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, bool ok){
+        if(!ok){
+            std::cout << what << " failed" << std::endl;
+            nfailed++;
+        }
+    };
+    const std::vector<int64_t> rowsplits = {0,2,5,6,8,8,12};
+
+    //ragged split: the remaining row splits start at 0 again
+    auto arr = countingRagged(rowsplits);
+    auto first = arr.split(2);
+    check("ragged split first part", counts(first,0,10)
+            && first.rowsplits()==std::vector<int64_t>({0,2,5}));
+    check("ragged split remaining part", counts(arr,10,14)
+            && arr.rowsplits()==std::vector<int64_t>({0,1,3,3,7}) && arr.shape().at(0)==4);
+
+    //split then append
+    arr.append(first);
+    check("ragged append after split", counts(arr.getSlice(0,4),10,14) && counts(arr.getSlice(4,6),0,10)
+            && arr.rowsplits()==std::vector<int64_t>({0,1,3,3,7,9,12}));
+
+    //repeated splits and truncates
+    arr = countingRagged(rowsplits);
+    arr.split(1);
+    arr.truncate(4);
+    arr.truncate(4);
+    arr.split(1);
+    arr.truncate(2);
+    check("ragged repeated truncate", counts(arr,10,6) && arr.rowsplits()==std::vector<int64_t>({0,1,3}));
+
+    //copies only contain the part behind the offset
+    arr = countingRagged(rowsplits);
+    arr.split(3);
+    simpleArray<float> copied(arr);
+    check("ragged copy of offset array", counts(copied,12,12) && copied==arr
+            && copied.rowsplits()==std::vector<int64_t>({0,2,2,6}));
+    copied.append(copied);
+    check("ragged append to copy", counts(copied.getSlice(3,6),12,12)
+            && copied.rowsplits()==std::vector<int64_t>({0,2,2,6,8,8,12}));
+
+    //disowned memory starts at the allocated address
+    arr = countingRagged(rowsplits);
+    arr.split(4);
+    const arrayAllocator* alloc = arr.allocator();
+    const size_t nbytes = arr.allocatedBytes();
+    float* p = arr.disownData();
+    bool ok=true;
+    for(size_t i=0;i<8;i++)
+        ok &= p[i]==16+i;
+    check("ragged disownData on offset array", ok);
+    alloc->deallocate(p, nbytes);
+
+    return nfailed;
+}
+
 int main(){
 
 
@@ -55,6 +130,13 @@ int main(){
 
     farr2.cout();
 
+    size_t nfailed = testOffsetArrays();
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 2;
+    }
+    std::cout << "all checks passed" << std::endl;
+
     return 1;
 
     for(float i=0;i<farr2.size();i++){
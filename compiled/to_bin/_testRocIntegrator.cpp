@@ -0,0 +1,76 @@
+#include "../interface/rocIntegrator.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+/*
+ * compares the sort-based ROC to a brute-force pair count, and the
+ * bounded-memory sketch (also merged from parts) to the exact result
+ */
+int main(){
+
+    srand(1);
+    const size_t nsig=3000, nbkg=5000;
+    std::vector<float> sig(nsig), bkg(nbkg);
+    for(auto& s: sig)
+        s = (float)(rand()%1000)/1000. * 0.7 + 0.3;
+    for(auto& b: bkg)
+        b = (float)(rand()%1000)/1000. * 0.8;
+
+    //P(sig score > bkg score), ties count one half
+    double pairs=0;
+    for(const auto& s: sig)
+        for(const auto& b: bkg)
+            pairs += s>b ? 1. : (s==b ? 0.5 : 0.);
+    pairs /= (double)(nsig*nbkg);
+
+    rocIntegrator exact;
+    rocIntegrator sketch(500), part0(500), part1(500);
+    for(size_t i=0;i<nsig;i++){
+        exact.add(sig[i],1,0);
+        sketch.add(sig[i],1,0);
+        (i%2 ? part1 : part0).add(sig[i],1,0);
+    }
+    for(size_t i=0;i<nbkg;i++){
+        exact.add(bkg[i],0,1);
+        sketch.add(bkg[i],0,1);
+        (i%2 ? part1 : part0).add(bkg[i],0,1);
+    }
+    part0.merge(part1);
+
+    exact.compute(4);
+    sketch.compute();
+    part0.compute();
+
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, double a, double b, double tol){
+        if(std::fabs(a-b)>tol){
+            std::cout << what << ": " << a << " vs " << b << std::endl;
+            nfailed++;
+        }
+    };
+    check("exact AUC", exact.auc(), pairs, 1e-9);
+    check("exact area", exact.area(), 1.-pairs, 1e-9);
+    check("sketch AUC", sketch.auc(), pairs, 5e-3);
+    check("merged sketch AUC", part0.auc(), pairs, 5e-3);
+    if(sketch.size()>1000){
+        std::cout << "sketch not bounded: " << sketch.size() << std::endl;
+        nfailed++;
+    }
+
+    //working point: at the threshold, the efficiency is the fraction above
+    rocIntegrator::workingPoint wp=exact.atMisid(0.01);
+    double above=0;
+    for(const auto& s: sig)
+        if(s>=wp.score) above++;
+    check("eff at misid", wp.eff, above/nsig, 2e-3);
+    check("misid at eff", exact.atEfficiency(wp.eff).misid, 0.01, 1e-3);
+
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "../interface/runningStats.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+/*
+ * compares streaming and merged statistics to a two-pass calculation,
+ * checks the quantile sketch and the text round trip
+ */
+int main(){
+
+    srand(2);
+    const size_t n=200000;
+    std::vector<float> vals(n);
+    for(auto& v: vals)
+        v = 1e4 + (float)(rand()%100000)/1000.;//large offset, small spread
+    vals.at(10) = NAN;
+    vals.at(20) = INFINITY;
+
+    double sum=0, nfinite=0;
+    for(const auto& v: vals)
+        if(std::isfinite(v)){ sum+=v; nfinite++; }
+    const double mean=sum/nfinite;
+    double var=0;
+    for(const auto& v: vals)
+        if(std::isfinite(v)) var+=(v-mean)*(v-mean);
+    var/=nfinite;
+
+    runningStats single(1000), parts[3]={runningStats(1000),runningStats(1000),runningStats(1000)};
+    for(size_t i=0;i<n;i++)
+        single.add(vals[i]);
+    //batches of different size, merged afterwards
+    parts[0].add(vals.data(), 17);
+    parts[1].add(vals.data()+17, n/2-17);
+    parts[2].add(vals.data()+n/2, n-n/2);
+    parts[0].merge(parts[1]);
+    parts[0].merge(parts[2]);
+
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, double a, double b, double tol){
+        if(std::fabs(a-b)>tol){
+            std::cout << what << ": " << a << " vs " << b << std::endl;
+            nfailed++;
+        }
+    };
+    check("count", single.count(), nfinite, 0);
+    check("non-finite", parts[0].nonFinite(), 2, 0);
+    check("mean", single.mean(), mean, 1e-8);
+    check("variance", single.variance(), var, 1e-6*var);
+    check("merged mean", parts[0].mean(), mean, 1e-8);
+    check("merged variance", parts[0].variance(), var, 1e-6*var);
+
+    std::vector<float> sorted;
+    for(const auto& v: vals)
+        if(std::isfinite(v)) sorted.push_back(v);
+    std::sort(sorted.begin(),sorted.end());
+    for(double q: {0.01, 0.25, 0.5, 0.75, 0.99}){
+        double exact=sorted.at((size_t)(q*(sorted.size()-1)));
+        check("quantile", single.quantile(q), exact, 0.01*(sorted.back()-sorted.front()));
+        check("merged quantile", parts[0].quantile(q), exact, 0.01*(sorted.back()-sorted.front()));
+    }
+
+    //per element and round trip
+    branchStatistics stats({"a","b"}, 2, 100), other({"a","b"}, 2, 100);
+    stats.total(0).add(vals.data(), 1000);
+    stats.element(1,1).add(3.);
+    other.element(1,1).add(5.);
+    stats.merge(other);
+    std::stringstream ss;
+    stats.write(ss);
+    branchStatistics read({});
+    read.read(ss);
+    check("round trip mean", read.total(0).mean(), stats.total(0).mean(), 1e-12);
+    check("round trip elements", read.nElements(1), 2, 0);
+    check("element mean", read.element(1,1).mean(), 4, 1e-12);
+    check("element norm", read.element(1,1).std(), 1, 1e-12);
+
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
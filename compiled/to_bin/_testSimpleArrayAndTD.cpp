@@ -26,6 +26,85 @@ void coutarray(const simpleArray<float> & farr){
 }
 
 
+static simpleArray<float> counting(std::vector<int> shape){
+    simpleArray<float> a(shape);
+    for(size_t i=0;i<a.size();i++)
+        a.data()[i]=i;
+    return a;
+}
+
+static bool counts(const simpleArray<float>& a, float first, size_t n){
+    if(a.size()!=n) return false;
+    for(size_t i=0;i<n;i++)
+        if(a.data()[i]!=first+i) return false;
+    return true;
+}
+
+/*
+ * split keeps the remaining part in the same buffer behind an offset,
+ * checks the operations that have to respect that offset
+ */
+static size_t testOffsetArrays(){
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, bool ok){
+        if(!ok){
+            std::cout << what << " failed" << std::endl;
+            nfailed++;
+        }
+    };
+
+    //split then append: the appended part goes behind the remaining part
+    auto arr = counting({10,3});
+    auto first = arr.split(4);
+    check("split first part", counts(first,0,12) && first.shape()==std::vector<int>({4,3}));
+    check("split remaining part", counts(arr,12,18) && arr.shape()==std::vector<int>({6,3}));
+    arr.append(first);
+    check("append after split shape", arr.shape()==std::vector<int>({10,3}));
+    check("append after split remaining", counts(arr.getSlice(0,6),12,18));
+    check("append after split appended", counts(arr.getSlice(6,10),0,12));
+
+    //append to itself with an offset
+    arr = counting({10,3});
+    arr.split(7);
+    arr.append(arr);
+    check("self append after split", counts(arr.getSlice(0,3),21,9) && counts(arr.getSlice(3,6),21,9));
+
+    //repeated splits and truncates
+    arr = counting({20,2});
+    arr.split(3);
+    arr.truncate(15);
+    arr.truncate(15);
+    arr.split(5);
+    arr.truncate(4);
+    check("repeated truncate", counts(arr,16,8) && arr.shape()==std::vector<int>({4,2}));
+    arr.truncate(0);
+    check("truncate to empty", arr.size()==0 && arr.shape()==std::vector<int>({0,2}));
+
+    //copies only contain the part behind the offset
+    arr = counting({10,3});
+    arr.split(2);
+    simpleArray<float> copied(arr);
+    check("copy of offset array", counts(copied,6,24) && copied==arr);
+    arr.data()[0]=-1;
+    check("copy is independent", copied.data()[0]==6);
+    copied.append(copied);
+    check("append to copy", counts(copied.getSlice(8,16),6,24));
+
+    //disowned memory starts at the allocated address
+    arr = counting({10,3});
+    arr.split(5);
+    const arrayAllocator* alloc = arr.allocator();
+    const size_t nbytes = arr.allocatedBytes();
+    float* p = arr.disownData();
+    bool ok=true;
+    for(size_t i=0;i<15;i++)
+        ok &= p[i]==15+i;
+    check("disownData on offset array", ok);
+    alloc->deallocate(p, nbytes);
+
+    return nfailed;
+}
+
 int main(){
 //#define igonrefownow
 #ifdef igonrefownow
@@ -165,4 +244,12 @@ int main(){
     std::cout << "done reading file "<< std::endl;
 
 #endif
+
+    size_t nfailed = testOffsetArrays();
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
 }
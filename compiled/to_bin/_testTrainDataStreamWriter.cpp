@@ -0,0 +1,104 @@
+#include "../interface/trainData.h"
+#include "../interface/trainDataStreamWriter.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace djc;
+
+/*
+ * writes the same dense and ragged data with writeToFile and with
+ * trainDataStreamWriter in blocks: with one chunk per array the files
+ * are identical, with many chunks per array they read back the same
+ */
+
+static trainData<float> makeData(size_t nentries){
+    std::vector<int64_t> rowsplits(1,0);
+    for(size_t i=0;i<nentries;i++)
+        rowsplits.push_back(rowsplits.back() + rand()%8);//also empty entries
+    simpleArray<float> dense({(int)nentries,10,4}), ragged({(int)nentries,-1,3},rowsplits),
+            truth({(int)nentries,2}), weight({(int)nentries,1});
+    for(auto* a: {&dense, &ragged, &truth, &weight})
+        for(size_t i=0;i<a->size();i++)
+            a->data()[i] = (float)(rand()%1000)/100.;
+    trainData<float> td;
+    td.storeFeatureArray(dense);
+    td.storeFeatureArray(ragged);
+    td.storeTruthArray(truth);
+    td.storeWeightArray(weight);
+    return td;
+}
+
+static std::vector<char> readBytes(const std::string& file){
+    std::ifstream in(file, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void streamWrite(const trainData<float>& td, const std::string& file, size_t chunkbytes){
+    trainDataStreamWriter<float> writer(file, 2, chunkbytes);
+    const size_t block=7777;
+    for(size_t i=0;i<td.nElements();i+=block)
+        writer.append(td.getSlice(i, std::min(i+block, (size_t)td.nElements())));
+    writer.close();
+}
+
+static bool sameContent(const trainData<float>& a, const trainData<float>& b){
+    if(a.nFeatureArrays()!=b.nFeatureArrays() || a.nTruthArrays()!=b.nTruthArrays()
+            || a.nWeightArrays()!=b.nWeightArrays())
+        return false;
+    for(int i=0;i<a.nFeatureArrays();i++)
+        if(a.featureArray(i)!=b.featureArray(i)) return false;
+    for(int i=0;i<a.nTruthArrays();i++)
+        if(a.truthArray(i)!=b.truthArray(i)) return false;
+    for(int i=0;i<a.nWeightArrays();i++)
+        if(a.weightArray(i)!=b.weightArray(i)) return false;
+    return true;
+}
+
+int main(){
+
+    srand(3);
+    const std::string prefix="/tmp/_testTrainDataStreamWriter_"+std::to_string(getpid());
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, bool ok){
+        if(!ok){
+            std::cout << what << " failed" << std::endl;
+            nfailed++;
+        }
+    };
+
+    //~32MB dense, ~12MB ragged
+    trainData<float> td = makeData(200000);
+    td.writeToFile(prefix+"_ref.djctd");
+
+    //one chunk per array
+    streamWrite(td, prefix+"_one.djctd", (size_t)256 << 20);
+    check("identical bytes", readBytes(prefix+"_ref.djctd") == readBytes(prefix+"_one.djctd"));
+
+    //smallest chunks, many per array
+    streamWrite(td, prefix+"_many.djctd", 1);
+    trainData<float> ref, one, many, manybuffered;
+    ref.readFromFile(prefix+"_ref.djctd");
+    one.readFromFile(prefix+"_one.djctd");
+    many.readFromFile(prefix+"_many.djctd");
+    manybuffered.readFromFileBuffered(prefix+"_many.djctd");
+    check("reference read", sameContent(ref, td));
+    check("one chunk read", sameContent(one, td));
+    check("many chunks read", sameContent(many, td));
+    check("many chunks buffered read", sameContent(manybuffered, td));
+
+    for(const auto& s: {"_ref.djctd", "_one.djctd", "_many.djctd"})
+        remove((prefix+s).data());
+
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
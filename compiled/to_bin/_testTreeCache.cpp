@@ -0,0 +1,112 @@
+#include "../interface/c_helper.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeCache.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <exception>
+
+/*
+ * setupTreeCache with a branch list on the test file: only the listed
+ * branches are enabled and cached, and the values read through the cache
+ * are the same as without cache and with all branches enabled.
+ * usage: _testTreeCache [testing/files/root_file0.root]
+ */
+
+static const char* treename="deepntuplizer/tree";
+
+static std::vector<std::vector<double> > readValues(TTree* tree, const std::vector<TString>& branches){
+    std::vector<std::vector<double> > out(branches.size());
+    for(Long64_t e=0;e<tree->GetEntries();e++){
+        tree->GetEntry(e);
+        for(size_t i=0;i<branches.size();i++)
+            out.at(i).push_back(tree->GetLeaf(branches.at(i))->GetValue());
+    }
+    return out;
+}
+
+static bool isCached(const TTreeCache* cache, const TString& branch){
+    const TObjArray* cached = cache->GetCachedBranches();
+    return cached && cached->FindObject(branch);
+}
+
+int main(int argc, char** argv){
+
+    const TString filename = argc>1 ? argv[1] : "testing/files/root_file0.root";
+    const std::vector<TString> branches={"x","class1"};
+    size_t nfailed=0;
+    auto check=[&nfailed](const char* what, bool ok){
+        if(!ok){
+            std::cout << what << " failed" << std::endl;
+            nfailed++;
+        }
+    };
+
+    try{
+        //reference: no cache, all branches
+        setTreeReadOptions(0, false);
+        TFile* reffile = openForReading(filename);
+        TTree* reftree = (TTree*)reffile->Get(treename);
+        checkTObject(reftree, "_testTreeCache: input tree problem");
+        reftree->SetCacheSize(0);
+        const auto expected = readValues(reftree, branches);
+        check("reference entries", reftree->GetEntries()>0);
+        delete reffile;
+
+        //without cache the branch list still applies
+        TFile* nocachefile = openForReading(filename);
+        TTree* nocachetree = (TTree*)nocachefile->Get(treename);
+        setupTreeCache(nocachetree, branches);
+        check("no cache: listed branches enabled",
+                nocachetree->GetBranchStatus("x") && nocachetree->GetBranchStatus("class1"));
+        check("no cache: other branches disabled", !nocachetree->GetBranchStatus("class2"));
+        check("no cache: values", readValues(nocachetree, branches)==expected);
+        delete nocachefile;
+
+        for(Long64_t cachesize: {(Long64_t)-1, (Long64_t)(1<<20), (Long64_t)1000}){
+            const std::string what = "cache size "+std::to_string(cachesize)+": ";
+            setTreeReadOptions(cachesize, false);
+            TFile* file = openForReading(filename);
+            TTree* tree = (TTree*)file->Get(treename);
+            setupTreeCache(tree, branches);
+
+            check((what+"listed branches enabled").data(),
+                    tree->GetBranchStatus("x") && tree->GetBranchStatus("class1"));
+            check((what+"other branches disabled").data(), !tree->GetBranchStatus("class2"));
+
+            TTreeCache* cache = dynamic_cast<TTreeCache*>(file->GetCacheRead(tree));
+            check((what+"cache exists").data(), cache);
+            if(cache){
+                check((what+"not learning").data(), !cache->IsLearning());
+                check((what+"listed branches cached").data(), isCached(cache,"x") && isCached(cache,"class1"));
+                check((what+"other branches not cached").data(), !isCached(cache,"class2"));
+            }
+            check((what+"values").data(), readValues(tree, branches)==expected);
+            delete file;
+        }
+
+        //without a branch list, all stay enabled and the cache learns
+        setTreeReadOptions(-1, false);
+        TFile* learnfile = openForReading(filename);
+        TTree* learntree = (TTree*)learnfile->Get(treename);
+        setupTreeCache(learntree);
+        check("learning: all branches enabled", learntree->GetBranchStatus("x")
+                && learntree->GetBranchStatus("class1") && learntree->GetBranchStatus("class2"));
+        check("learning: values", readValues(learntree, branches)==expected);
+        delete learnfile;
+    }
+    catch(const std::exception& e){
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    if(nfailed){
+        std::cout << nfailed << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,383 @@
+/*
+ * benchmarkPipeline.cpp
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+/*
+ * Throughput of the data pipeline: quicklz compression, simpleArray
+ * getSlice/append/shuffle, trainData write/read and trainDataGenerator
+ * batches, for dense and ragged data, several sizes and thread counts.
+ * With n threads, n independent copies of the work run at the same time
+ * (appendMany uses its own threads), so the result is the aggregate
+ * throughput of the machine. Files are read back from the page cache.
+ *
+ * One result per line, csv (default) or json lines:
+ *   benchmark,layout,entries,threads,seconds,items_per_s,mb_per_s,ratio
+ * seconds is the median of the repeats, items are entries, slices or batches.
+ *
+ * benchmarkPipeline [--quick] [--json] [--entries 10000,100000] [--threads 1,4]
+ *                   [--repeats 3] [--batch 256] [--dir /tmp] [--only compress,generator]
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <unistd.h>
+#include "../interface/quicklzWrapper.h"
+#include "../interface/simpleArray.h"
+#include "../interface/trainData.h"
+#include "../interface/trainDataGenerator.h"
+#include "../interface/fastRandom.h"
+
+using namespace djc;
+
+struct benchConfig{
+    std::vector<size_t> entries={10000,100000};
+    std::vector<size_t> threads={1,std::max(2u,std::thread::hardware_concurrency())};
+    size_t repeats=3;
+    size_t batch=256;
+    std::string dir="/tmp";
+    bool json=false;
+    std::set<std::string> only;
+
+    bool run(const std::string& name)const{
+        return only.empty() || only.count(name);
+    }
+};
+
+struct benchResult{
+    std::string name, layout;
+    size_t entries, threads;
+    double seconds, items, bytes, ratio;
+};
+
+static void print(const benchConfig& cfg, const benchResult& r){
+    const double itemsps = r.seconds>0 ? r.items/r.seconds : 0;
+    const double mbps = r.seconds>0 ? r.bytes/r.seconds/1e6 : 0;
+    if(cfg.json){
+        std::cout << "{\"benchmark\": \"" << r.name << "\", \"layout\": \"" << r.layout
+                << "\", \"entries\": " << r.entries << ", \"threads\": " << r.threads
+                << ", \"seconds\": " << r.seconds << ", \"items_per_s\": " << itemsps
+                << ", \"mb_per_s\": " << mbps;
+        if(r.ratio>0)
+            std::cout << ", \"ratio\": " << r.ratio;
+        std::cout << "}" << std::endl;
+    }
+    else{
+        std::cout << r.name << ',' << r.layout << ',' << r.entries << ',' << r.threads << ','
+                << r.seconds << ',' << itemsps << ',' << mbps << ',';
+        if(r.ratio>0)
+            std::cout << r.ratio;
+        std::cout << std::endl;
+    }
+}
+
+/* median wall time of f() over the repeats */
+template<class F>
+static double timeMedian(size_t repeats, F f){
+    std::vector<double> times;
+    for(size_t i=0;i<repeats;i++){
+        auto start=std::chrono::steady_clock::now();
+        f();
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count());
+    }
+    std::sort(times.begin(),times.end());
+    return times.at(times.size()/2);
+}
+
+/* f(t) on nthreads threads at the same time */
+template<class F>
+static void concurrently(size_t nthreads, F f){
+    if(nthreads<2){
+        f(0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for(size_t t=0;t<nthreads;t++)
+        threads.emplace_back(f,t);
+    for(auto& t: threads)
+        t.join();
+}
+
+/*
+ * entries with a long-tailed number of candidates (8 features each),
+ * dense: zero-padded to 40 candidates, ragged: as is
+ */
+static simpleArray<float> makeArray(bool ragged, size_t nentries, uint64_t seed){
+    const int nfeat=8, maxcand=40;
+    fastRandom rand(seed);
+    std::vector<int64_t> rowsplits(1,0);
+    std::vector<int> ncand(nentries);
+    for(auto& n: ncand){
+        n = 1 + (int)(-12.*std::log(1.-rand.uniform()));
+        if(ragged)
+            rowsplits.push_back(rowsplits.back()+n);
+    }
+    simpleArray<float> a = ragged ? simpleArray<float>({(int)nentries,-1,nfeat},rowsplits)
+            : simpleArray<float>({(int)nentries,maxcand,nfeat});
+    float * d = a.data();
+    for(size_t e=0;e<nentries;e++){
+        const int n = ragged ? ncand[e] : maxcand;
+        for(int c=0;c<n;c++){
+            for(int f=0;f<nfeat;f++){
+                float v=0;
+                if(c<ncand[e])//two decimals, as from typical inputs
+                    v = std::round((rand.uniform()-0.5)*400.)/100.;
+                *d++ = v;
+            }
+        }
+    }
+    return a;
+}
+
+static trainData<float> makeTrainData(const simpleArray<float>& features){
+    trainData<float> td;
+    simpleArray<float> f(features);
+    td.storeFeatureArray(f);
+    simpleArray<float> truth({(int)features.getFirstDimension(),5});
+    for(size_t i=0;i<truth.size();i++)
+        truth.data()[i] = (i%5==0);
+    td.storeTruthArray(truth);
+    return td;
+}
+
+static std::string tmpFile(const benchConfig& cfg, const std::string& what, size_t t){
+    std::stringstream ss;
+    ss << cfg.dir << "/djc_benchmark_" << getpid() << "_" << what << "_" << t << ".djctd";
+    return ss.str();
+}
+
+static void benchArrays(const benchConfig& cfg, bool ragged, size_t nentries){
+    const std::string layout = ragged ? "ragged" : "dense";
+    const simpleArray<float> arr = makeArray(ragged, nentries, 42);
+    const double bytes = arr.size()*sizeof(float);
+    const size_t nslices = std::max((size_t)1, nentries/cfg.batch);
+
+    for(size_t nthreads: cfg.threads){
+        const double n = nthreads;
+
+        if(cfg.run("compress") || cfg.run("decompress")){
+            //compressed once, in memory
+            std::vector<char> compressed(bytes+400);
+            size_t csize=0;
+            {
+                quicklz<float> q;
+                csize = q.compressChunk((const char*)arr.data(), bytes, compressed.data());
+            }
+            if(cfg.run("compress")){
+                std::vector<std::vector<char> > dst(nthreads, std::vector<char>(bytes+400));
+                double s = timeMedian(cfg.repeats, [&](){
+                    concurrently(nthreads, [&](size_t t){
+                        quicklz<float> q;
+                        q.compressChunk((const char*)arr.data(), bytes, dst.at(t).data());
+                    });
+                });
+                print(cfg, {"compress", layout, nentries, nthreads, s, n*nentries, n*bytes, bytes/csize});
+            }
+            if(cfg.run("decompress")){
+                //file layout as written by writeCompressed, read from memory
+                char * buf=0;
+                size_t buflen=0;
+                FILE * mem = open_memstream(&buf, &buflen);
+                {
+                    quicklz<float> q;
+                    q.writeCompressed(arr.data(), arr.size(), mem);
+                }
+                fclose(mem);
+                std::vector<std::vector<float> > out(nthreads, std::vector<float>(arr.size()));
+                double s = timeMedian(cfg.repeats, [&](){
+                    concurrently(nthreads, [&](size_t t){
+                        FILE * f = fmemopen(buf, buflen, "rb");
+                        quicklz<float> q;
+                        q.readAll(f, out.at(t).data());
+                        fclose(f);
+                    });
+                });
+                free(buf);
+                print(cfg, {"decompress", layout, nentries, nthreads, s, n*nentries, n*bytes, bytes/csize});
+            }
+        }
+
+        if(cfg.run("getSlice")){
+            std::vector<std::vector<size_t> > starts(nthreads);
+            for(size_t t=0;t<nthreads;t++){
+                fastRandom rand(7,t);
+                for(size_t i=0;i<nslices;i++)
+                    starts.at(t).push_back(rand.below(nentries-std::min(cfg.batch,nentries)+1));
+            }
+            double s = timeMedian(cfg.repeats, [&](){
+                concurrently(nthreads, [&](size_t t){
+                    for(const auto& b: starts.at(t)){
+                        simpleArray<float> slice = arr.getSlice(b, std::min(b+cfg.batch,nentries));
+                    }
+                });
+            });
+            print(cfg, {"getSlice", layout, nentries, nthreads, s, n*nslices, n*nslices*std::min(cfg.batch,nentries)*bytes/nentries, 0});
+        }
+
+        if(cfg.run("append") || cfg.run("appendMany")){
+            std::vector<simpleArray<float> > chunks;
+            for(size_t b=0;b<nentries;b+=cfg.batch)
+                chunks.push_back(arr.getSlice(b, std::min(b+cfg.batch,nentries)));
+            if(cfg.run("append") && nthreads==cfg.threads.front()){
+                double s = timeMedian(cfg.repeats, [&](){
+                    simpleArray<float> out;
+                    for(const auto& c: chunks)
+                        out.append(c);
+                });
+                print(cfg, {"append", layout, nentries, 1, s, (double)nentries, bytes, 0});
+            }
+            if(cfg.run("appendMany")){
+                double s = timeMedian(cfg.repeats, [&](){
+                    simpleArray<float> out;
+                    out.appendMany(chunks, nthreads);
+                });
+                print(cfg, {"appendMany", layout, nentries, nthreads, s, (double)nentries, bytes, 0});
+            }
+        }
+
+        if(cfg.run("shuffle")){
+            std::vector<size_t> idxs(nentries);
+            std::iota(idxs.begin(), idxs.end(), 0);
+            fastRandom rand(11);
+            std::shuffle(idxs.begin(), idxs.end(), rand);
+            double s = timeMedian(cfg.repeats, [&](){
+                concurrently(nthreads, [&](size_t){
+                    simpleArray<float> shuffled = arr.shuffle(idxs);
+                });
+            });
+            print(cfg, {"shuffle", layout, nentries, nthreads, s, n*nentries, n*bytes, 0});
+        }
+
+        if(cfg.run("td_write") || cfg.run("td_read") || cfg.run("td_read_buffered")){
+            const trainData<float> td = makeTrainData(arr);
+            const double tdbytes = bytes + nentries*5*sizeof(float);
+            std::vector<std::string> files;
+            for(size_t t=0;t<nthreads;t++)
+                files.push_back(tmpFile(cfg, "td", t));
+            double s = timeMedian(cfg.repeats, [&](){
+                concurrently(nthreads, [&](size_t t){
+                    td.writeToFile(files.at(t));
+                });
+            });
+            if(cfg.run("td_write"))
+                print(cfg, {"td_write", layout, nentries, nthreads, s, n*nentries, n*tdbytes, 0});
+            for(int buffered=0;buffered<2;buffered++){
+                const std::string name = buffered ? "td_read_buffered" : "td_read";
+                if(!cfg.run(name))
+                    continue;
+                s = timeMedian(cfg.repeats, [&](){
+                    concurrently(nthreads, [&](size_t t){
+                        trainData<float> in;
+                        if(buffered)
+                            in.readFromFileBuffered(files.at(t));
+                        else
+                            in.readFromFile(files.at(t));
+                    });
+                });
+                print(cfg, {name, layout, nentries, nthreads, s, n*nentries, n*tdbytes, 0});
+            }
+            for(const auto& f: files)
+                std::remove(f.c_str());
+        }
+    }
+
+    //the generator reads with its own thread, one generator per run
+    for(int arena=0;arena<2;arena++){
+        const std::string name = arena ? "generator_arena" : "generator";
+        if(!cfg.run(name))
+            continue;
+        const size_t nfiles=4;
+        std::vector<std::string> files;
+        for(size_t i=0;i<nfiles;i++){
+            files.push_back(tmpFile(cfg, "gen", i));
+            makeTrainData(arr.getSlice(nentries*i/nfiles, nentries*(i+1)/nfiles)).writeToFile(files.back());
+        }
+        trainDataGenerator<float> gen;
+        gen.setUseArena(arena);
+        gen.setBatchSize(cfg.batch);//before the files, then the splitting is prepared once
+        gen.setFileList(files);
+        size_t nbatches=0;
+        double s = timeMedian(cfg.repeats, [&](){
+            gen.prepareNextEpoch();
+            nbatches = gen.getNBatches();
+            for(size_t i=0;i<nbatches;i++)
+                trainData<float> b = gen.getBatch();
+        });
+        gen.end();
+        print(cfg, {name, layout, nentries, 1, s, (double)nbatches, bytes, 0});
+        for(const auto& f: files)
+            std::remove(f.c_str());
+    }
+}
+
+static std::vector<size_t> parseList(const std::string& s){
+    std::vector<size_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while(std::getline(ss, item, ','))
+        out.push_back(std::stoul(item));
+    if(out.empty())
+        throw std::runtime_error("empty list "+s);
+    return out;
+}
+
+int main(int argc, char** argv){
+
+    benchConfig cfg;
+    try{
+        for(int i=1;i<argc;i++){
+            std::string a=argv[i];
+            auto next=[&]()->std::string{
+                if(i+1>=argc)
+                    throw std::runtime_error("missing value for "+a);
+                return argv[++i];
+            };
+            if(a=="--quick"){
+                cfg.entries={5000};
+                cfg.threads={1,2};
+                cfg.repeats=1;
+            }
+            else if(a=="--json") cfg.json=true;
+            else if(a=="--entries") cfg.entries=parseList(next());
+            else if(a=="--threads") cfg.threads=parseList(next());
+            else if(a=="--repeats") cfg.repeats=std::max((size_t)1,(size_t)std::stoul(next()));
+            else if(a=="--batch") cfg.batch=std::max((size_t)1,(size_t)std::stoul(next()));
+            else if(a=="--dir") cfg.dir=next();
+            else if(a=="--only"){
+                std::stringstream ss(next());
+                std::string item;
+                while(std::getline(ss, item, ','))
+                    cfg.only.insert(item);
+            }
+            else{
+                std::cerr << "usage: " << argv[0] << " [--quick] [--json] [--entries n,n] [--threads n,n]"
+                        " [--repeats n] [--batch n] [--dir path] [--only name,name]" << std::endl;
+                return 1;
+            }
+        }
+
+        if(!cfg.json)
+            std::cout << "benchmark,layout,entries,threads,seconds,items_per_s,mb_per_s,ratio" << std::endl;
+        for(const auto& n: cfg.entries){
+            benchArrays(cfg, false, n);
+            benchArrays(cfg, true, n);
+        }
+    }
+    catch(const std::exception& e){
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * makeSyntheticData.cpp
+ *
+ *  Created on: 19 Oct 2026
+ */
+
+/*
+ * Writes a synthetic dataset of djctd files for scale tests of the
+ * training pipeline, e.g. 1000 files of 1M entries:
+ *
+ * makeSyntheticData --out /data/synth --files 1000 --entries 1000000
+ *                   --features ragged:8,dense:40x8,flat:30 --truth onehot:5
+ *                   --multiplicity pareto:2:1.5:2000 --threads 16
+ *
+ * Array specs (comma separated):      Multiplicities (candidates per entry):
+ *   flat:n      [entries, n]              fixed:n
+ *   dense:nxf   [entries, n, f] padded    uniform:min:max
+ *   ragged:f    [entries, -1, f]          exp:mean:max
+ *   onehot:n    [entries, n]              pareto:min:alpha:max
+ *
+ * Values are normal distributed, rounded to --decimals decimals (-1: not
+ * rounded, hardly compressible). Files are generated in parallel, one
+ * thread per file, each streamed to disk in blocks of --block entries
+ * and compressed in chunks of --chunkmb MB, so memory stays bounded for
+ * any file size. File i only depends on --seed and i, not on the threads.
+ * A filelist.txt with all files is written to the output directory.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <sys/stat.h>
+#include "../interface/syntheticData.h"
+#include "../interface/trainDataStreamWriter.h"
+#include "../interface/fastRandom.h"
+
+using namespace djc;
+
+struct synthConfig{
+    std::string out=".";
+    std::string prefix="synthetic_";
+    size_t files=1;
+    size_t entries=100000;
+    std::string features="ragged:8,dense:40x8,flat:30";
+    std::string truths="onehot:5";
+    std::string weights="";
+    std::string multiplicity="exp:12:400";
+    int decimals=2;
+    size_t threads=std::max(1u,std::thread::hardware_concurrency());
+    uint64_t seed=1;
+    size_t chunkmb=256;
+    size_t block=10000;
+};
+
+static void usage(const char* name){
+    std::cerr << "usage: " << name << " [--out dir] [--prefix name] [--files n] [--entries n]\n"
+            "    [--features specs] [--truth specs] [--weights specs] [--multiplicity spec]\n"
+            "    [--decimals n] [--threads n] [--seed n] [--chunkmb n] [--block n]" << std::endl;
+}
+
+static std::string fileName(const synthConfig& cfg, size_t i){
+    char num[32];
+    snprintf(num, sizeof(num), "%05zu", i);
+    return cfg.prefix + num + ".djctd";
+}
+
+int main(int argc, char** argv){
+
+    synthConfig cfg;
+    try{
+        for(int i=1;i<argc;i++){
+            std::string a=argv[i];
+            auto next=[&]()->std::string{
+                if(i+1>=argc)
+                    throw std::runtime_error("missing value for "+a);
+                return argv[++i];
+            };
+            if(a=="--out") cfg.out=next();
+            else if(a=="--prefix") cfg.prefix=next();
+            else if(a=="--files") cfg.files=std::stoul(next());
+            else if(a=="--entries") cfg.entries=std::stoul(next());
+            else if(a=="--features") cfg.features=next();
+            else if(a=="--truth") cfg.truths=next();
+            else if(a=="--weights") cfg.weights=next();
+            else if(a=="--multiplicity") cfg.multiplicity=next();
+            else if(a=="--decimals") cfg.decimals=std::stoi(next());
+            else if(a=="--threads") cfg.threads=std::max((size_t)1,(size_t)std::stoul(next()));
+            else if(a=="--seed") cfg.seed=std::stoull(next());
+            else if(a=="--chunkmb") cfg.chunkmb=std::max((size_t)1,(size_t)std::stoul(next()));
+            else if(a=="--block") cfg.block=std::max((size_t)1,(size_t)std::stoul(next()));
+            else{
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+        const syntheticData gen(cfg.features, cfg.truths, cfg.weights, cfg.multiplicity, cfg.decimals);
+        const double bytesperfile = gen.bytesPerEntry() * cfg.entries;
+        //an array can have at most 255 chunks
+        if(bytesperfile / ((double)cfg.chunkmb * (1<<20)) > 200)
+            std::cerr << "warning: about " << bytesperfile/1e6 << " MB per file, "
+                    "increase --chunkmb if writing fails" << std::endl;
+
+        mkdir(cfg.out.c_str(), 0755);
+        std::cout << "writing " << cfg.files << " files of " << cfg.entries << " entries, about "
+                << bytesperfile/1e6 << " MB each uncompressed, to " << cfg.out << std::endl;
+
+        std::atomic<size_t> nextfile(0);
+        std::mutex mtx;
+        std::string error;
+        size_t ndone=0;
+        double compressedbytes=0;
+        const auto start=std::chrono::steady_clock::now();
+
+        auto work=[&](){
+            while(true){
+                const size_t f = nextfile++;
+                if(f >= cfg.files)
+                    return;
+                try{
+                    const std::string path = cfg.out + "/" + fileName(cfg, f);
+                    fastRandom rand(cfg.seed, f);
+                    {
+                        //the generating thread compresses as well
+                        trainDataStreamWriter<float> writer(path, 1, cfg.chunkmb << 20);
+                        for(size_t done=0; done<cfg.entries; done+=cfg.block)
+                            writer.append(gen.block(std::min(cfg.block, cfg.entries-done), rand));
+                        writer.close();
+                    }
+                    struct stat st;
+                    const double size = stat(path.c_str(), &st) ? 0 : st.st_size;
+                    std::lock_guard<std::mutex> lock(mtx);
+                    ndone++;
+                    compressedbytes += size;
+                    const double sec=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+                    std::cout << "\r" << ndone << "/" << cfg.files << " files, "
+                            << sec << " s" << std::flush;
+                }
+                catch(const std::exception& e){
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if(error.empty())
+                        error = fileName(cfg, f) + ": " + e.what();
+                    nextfile = cfg.files;
+                    return;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for(size_t t=0;t<std::min(cfg.threads, cfg.files);t++)
+            threads.emplace_back(work);
+        for(auto& t: threads)
+            t.join();
+        std::cout << std::endl;
+        if(error.size())
+            throw std::runtime_error(error);
+
+        std::ofstream list(cfg.out + "/filelist.txt");
+        for(size_t f=0;f<cfg.files;f++)
+            list << fileName(cfg, f) << '\n';
+        if(!list)
+            throw std::runtime_error("could not write "+cfg.out+"/filelist.txt");
+
+        const double sec=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        const double entries = (double)cfg.entries * cfg.files;
+        std::cout << entries << " entries in " << sec << " s, "
+                << entries/sec << " entries/s, "
+                << bytesperfile*cfg.files/sec/1e6 << " MB/s uncompressed, "
+                << compressedbytes/1e6 << " MB on disk (ratio "
+                << (compressedbytes>0 ? bytesperfile*cfg.files/compressedbytes : 0) << ")" << std::endl;
+    }
+    catch(const std::exception& e){
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
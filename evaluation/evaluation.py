@@ -100,6 +100,52 @@ def createColours(colors_list,name_list,nnames=None,extralegend=[]):
         colors_list=newcolors   
     return   colors_list    
     
+def columnsFromTrainData(files, featurenames=[], truthnames=[], weightnames=[]):
+    '''
+    Reads trainData files (.djctd), e.g. predictions and truths stored with
+    TrainData.writeToFile, into columns for makeROCs_async/makePlots_async,
+    so that no ROOT friend trees need to be written.
+    The i-th feature/truth/weight array is named by the i-th entry of the
+    corresponding list, arrays named None are skipped. A non-empty list needs
+    one entry per array. Arrays with more than one value per entry are used
+    as name[j] in the expressions. Ragged arrays have no fixed number of
+    values per entry and can only be skipped.
+    '''
+    from DeepJetCore.TrainData import TrainData
+    import numpy as np
+    if isinstance(files, str):
+        files = [files]
+    parts = {}
+    for f in files:
+        td = TrainData()
+        td.readFromFile(f)
+        for what, names, ragged, transfer in (
+                ('feature', featurenames, td.getFeatureRaggedFlags(), td.transferFeatureListToNumpy),
+                ('truth', truthnames, td.getTruthRaggedFlags(), td.transferTruthListToNumpy),
+                ('weight', weightnames, td.getWeightRaggedFlags(), td.transferWeightListToNumpy)):
+            if not len(names):
+                continue
+            if len(names) != len(ragged):
+                raise ValueError("columnsFromTrainData: "+str(len(names))+" "+what+" names for "
+                                 +str(len(ragged))+" "+what+" arrays in "+f)
+            arrays = transfer()
+            #ragged feature and truth arrays come as values and row splits
+            ai = 0
+            for name, isragged in zip(names, ragged):
+                a = arrays[ai]
+                ai += 2 if isragged and what != 'weight' else 1
+                if name is None:
+                    continue
+                if isragged:
+                    raise ValueError("columnsFromTrainData: "+what+" array "+name+" in "+f
+                                     +" is ragged, use None to skip it")
+                a = np.asarray(a, dtype='float32')
+                if a.ndim > 2:
+                    a = a.reshape(a.shape[0], -1)
+                parts.setdefault(name, []).append(a)
+        td.clear()
+    return {n: np.ascontiguousarray(np.concatenate(a)) for n, a in parts.items()}
+
 def makeROCs_async(intextfile, name_list, probabilities_list, truths_list, vetos_list,
                     colors_list, outpdffile, cuts='',cmsstyle=False, firstcomment='',secondcomment='',
                     invalidlist='',
@@ -114,7 +160,19 @@ def makeROCs_async(intextfile, name_list, probabilities_list, truths_list, vetos
                     experimentlabel="",lumilabel="",prelimlabel="",
                     npoints=500,
                     yscales=1.,
-                    no_friend_tree=False):
+                    no_friend_tree=False,
+                    maxrocpoints=10000,
+                    columns=None,
+                    manifest=''):
+    '''
+    columns: dict of name -> float32 numpy array (see columnsFromTrainData).
+    If given, the expressions refer to these columns and intextfile is not used.
+    maxrocpoints: points kept per curve for the unbinned ROC, the error on
+    efficiency and mis-id is below ~2/maxrocpoints. 0 computes exact curves,
+    but keeps 12 bytes for every selected entry of every curve in memory.
+    manifest: file to cache the entry counts of all trees in, e.g. for
+    repeated evaluations of the same large lists. Empty: no cache.
+    '''
     
     import copy
     
@@ -157,6 +215,19 @@ def makeROCs_async(intextfile, name_list, probabilities_list, truths_list, vetos
     
     def worker():
         try:
+            if columns is not None:
+                c_makeROCs.makeROCsFromArrays(columns,namelistcopy,
+                        probabilities_list,
+                        truths_list,
+                        vetos_list,
+                        colors_list,
+                        outpdffile,allcuts,cmsstyle,
+                        firstcomment,secondcomment,
+                        invalidlist,extralegcopy,logY,
+                        xaxis,yaxis,nbins,xmin,
+                        experimentlabel,lumilabel,prelimlabel,yscaleslist,
+                        maxrocpoints)
+                return
             c_makeROCs.makeROCs(files,namelistcopy,
                         probabilities_list,
                         truths_list,
@@ -166,7 +237,8 @@ def makeROCs_async(intextfile, name_list, probabilities_list, truths_list, vetos
                         firstcomment,secondcomment,
                         invalidlist,extralegcopy,logY,
                         individual,xaxis,yaxis,nbins,treename,xmin,
-                        experimentlabel,lumilabel,prelimlabel,yscaleslist,no_friend_tree)
+                        experimentlabel,lumilabel,prelimlabel,yscaleslist,no_friend_tree,
+                        maxrocpoints,manifest)
         
         except Exception as e:
             print('error for these inputs:')
@@ -193,7 +265,14 @@ def makePlots_async(intextfile, name_list, variables, cuts, colours,
                      minimum=-1e100,maximum=1e100,widthprofile=False,
                      treename="deepntuplizer/tree",
                      nbins=0,xmin=0,xmax=0,
+                     columns=None,
+                     manifest=''
                      ): 
+    '''
+    columns: dict of name -> float32 numpy array (see columnsFromTrainData).
+    If given, the expressions refer to these columns and intextfile is not used.
+    manifest: file to cache the entry counts of all trees in, see makeROCs_async.
+    '''
     
     
     files_list=makeASequence(intextfile,len(name_list))
@@ -206,7 +285,12 @@ def makePlots_async(intextfile, name_list, variables, cuts, colours,
 
     from DeepJetCore.compiled import c_makePlots
     def worker():
-        if profiles:
+        if columns is not None:
+            c_makePlots.makePlotsFromArrays(columns,name_list,
+                                 variables_list,cuts_list,colours_list,
+                                 outpdffile,xaxis,yaxis,normalized,profiles,widthprofile,minimum,maximum,
+                                 nbins,xmin,xmax)
+        elif profiles:
             c_makePlots.makeProfiles(files_list,name_list,
                               variables_list,cuts_list,colours_list,
                                  outpdffile,xaxis,yaxis,normalized,minimum, maximum,treename)
@@ -214,7 +298,7 @@ def makePlots_async(intextfile, name_list, variables, cuts, colours,
             c_makePlots.makePlots(files_list,name_list,
                                  variables_list,cuts_list,colours_list,
                                  outpdffile,xaxis,yaxis,normalized,profiles,widthprofile,minimum,maximum,
-                                 treename,nbins,xmin,xmax)
+                                 treename,nbins,xmin,xmax,manifest)
     
 #    return worker()
     import multiprocessing
@@ -226,7 +310,8 @@ def makeEffPlots_async(intextfile, name_list, variables, cutsnum,cutsden, colour
                      outpdffile, xaxis='',yaxis='',
                      minimum=1e100,maximum=-1e100,
                      nbins=-1, SetLogY = False, Xmin = 100, Xmax = -100. ,
-                     treename="deepntuplizer/tree"): 
+                     treename="deepntuplizer/tree",
+                     manifest=''): 
     
     
     files_list=makeASequence(intextfile,len(name_list))
@@ -243,7 +328,7 @@ def makeEffPlots_async(intextfile, name_list, variables, cutsnum,cutsden, colour
         try:
             c_makePlots.makeEffPlots(files_list,name_list,
                                  variables_list,cutsnum_list,cutsden_list,colours_list,
-                                 outpdffile,xaxis,yaxis,nbins,SetLogY, Xmin, Xmax,minimum,maximum,treename)
+                                 outpdffile,xaxis,yaxis,nbins,SetLogY, Xmin, Xmax,minimum,maximum,treename,manifest)
         except Exception as e:
             print('error for these inputs:')
             print(files_list)
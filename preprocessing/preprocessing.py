@@ -8,6 +8,15 @@ import logging
 def setTreeName(name):
     from DeepJetCore.compiled import c_meanNormZeroPad
     c_meanNormZeroPad.setTreeName(name)
+
+def setTreeReadOptions(cachesize_mb=-1, prefetch=False):
+    """
+    TTreeCache size in MB for all ROOT readers (-1: ROOT default, 0: off)
+    and asynchronous prefetching, useful for remote files
+    """
+    from DeepJetCore.compiled import c_meanNormZeroPad
+    cachesize = cachesize_mb if cachesize_mb <= 0 else int(cachesize_mb*1024*1024)
+    c_meanNormZeroPad.setTreeReadOptions(cachesize, prefetch)
     
 
 def setDefaultsZero(inarray):
@@ -89,6 +98,36 @@ def produceWeigths(Tuple,nameX,nameY,bins,classes=[],normed=False):
     return weight
 
 
+def meanNormStatistics(filenames, branches, maxentries=-1, maxelements=0, quantilepoints=0, treename=None):
+    """
+    Means and norms of the branches in one C++ pass per file (threads as set
+    with c_meanNormZeroPad.setNThreads). Only the first maxentries entries of
+    each file are used if maxentries >= 0, e.g. for a cheap pre-pass.
+    For vector branches, statistics of the first maxelements elements are kept
+    as well, and approximate quantiles need quantilepoints > 0.
+    treename only applies to this call, default: as set with
+    c_meanNormZeroPad.setTreeName.
+    The returned c_meanNormZeroPad.normStatistics can also be filled in a
+    conversionPass (statistics), merged and written to or read from files.
+    """
+    from DeepJetCore.compiled import c_meanNormZeroPad
+    if treename is None:
+        treename = ''
+    if not isinstance(filenames, list):
+        filenames=[filenames]
+    stats = c_meanNormZeroPad.normStatistics(list(branches), maxelements, quantilepoints)
+    for f in filenames:
+        c_meanNormZeroPad.fillStatistics(stats, f, maxentries, treename)
+    return stats
+
+def meanNormFromStatistics(stats):
+    """
+    record array with the mean [0] and the norm [1] of each branch, as meanNormProd
+    """
+    names = stats.branches()
+    return numpy.array([tuple(stats.means()), tuple(stats.norms())],
+                       dtype=[(n, float) for n in names])
+
 def meanNormProd(Tuple):
     """
     This function makes a reacarray with the same fields (branches in root talk) as the input tree. The recarray has only two entries, the mean [0] and the st. dev. [1] for each field. If an field was an array the mean of all entries is taken. This is to be used to mean normalize the the input features to ML for faster convergence.
@@ -484,6 +523,30 @@ def MeanNormZeroPadParticles(Filename_in,MeanNormTuple,inbranches,nMax,nevents):
    
     return array
 
+def MeanNormZeroPadParticlesRagged(Filename_in,MeanNormTuple,inbranches,nMax=-1):
+    """
+    Same as MeanNormZeroPadParticles, but without padding. Returns a ragged
+    simpleArray of shape [events, -particles, len(inbranches)].
+    nMax <= 0 keeps all particles
+    """
+    from DeepJetCore.compiled import c_meanNormZeroPad
+    from DeepJetCore.compiled.c_simpleArray import simpleArray
+
+    means=[]
+    norms=[]
+    for b in inbranches:
+        if MeanNormTuple is None:
+            means.append(0)
+            norms.append(1)
+        else:
+            means.append(MeanNormTuple[b][0])
+            norms.append(MeanNormTuple[b][1])
+
+    data, rowsplits = c_meanNormZeroPad.particleclusterRagged(norms,means,inbranches,nMax,Filename_in)
+    arr = simpleArray()
+    arr.createFromNumpy(data, rowsplits)
+    return arr
+
 def MeanNormZeroPad(Filename_in,MeanNormTuple,inbranches_listlist,nMaxslist,nevents):
 
     """
@@ -551,9 +614,30 @@ def read2DArray(filename, treename, branchname, nevents: int, xsize: int, ysize:
     array = numpy.zeros((nevents,xsize//rebinx, ysize//rebiny,1) , dtype='float32')
     ncut=numpy.array([0],dtype='float32')
     c_arrayReads.read2DArray(array,filename, treename, branchname,rebinx,rebiny,zeropad, False, ncut)
-    
+
     return array
-    
+
+def readFlatArray(filename, treename, branchname, nevents: int, shape: list,
+                rebin: list=None, zeropad=False):
+    """
+    Reads an image stored row-major in a flat vector<float> branch.
+    shape is the image shape, e.g. [xsize, ysize, zsize]
+    """
+    if rebin is None:
+        rebin = [1 for _ in shape]
+    if len(rebin) != len(shape):
+        raise Exception("one rebinning factor per dimension needed")
+    for s,r in zip(shape,rebin):
+        if s%r:
+            raise Exception("rebinning factors don't not match the bin counts")
+
+    from DeepJetCore.compiled import c_arrayReads
+
+    array = numpy.zeros([nevents]+[s//r for s,r in zip(shape,rebin)]+[1] , dtype='float32')
+    c_arrayReads.readFlatArray(array,filename, treename, branchname,list(shape),list(rebin),zeropad)
+
+    return array
+
 def readListArray(filename, treename, branchname, nevents: int, list_size: int, n_feat_per_element: int,
                 zeropad=False, list_size_cut=False):
     
@@ -0,0 +1,76 @@
+'''
+tests c_randomSelect: probs are remove probabilities, so an entry is
+picked with weight 1-prob
+'''
+import numpy as np
+from DeepJetCore.compiled import c_randomSelect
+
+np.random.seed(1)
+n=10000
+probs=np.random.uniform(0,1,n)
+probs[::10]=1. #weight 0, never picked
+
+
+## randSelect picks exactly nentries new entries
+
+c_randomSelect.setSeed(7)
+selected=np.zeros(n,dtype='int32')
+selected[1::13]=1
+before=selected.copy()
+c_randomSelect.randSelect(probs,selected,3000)
+
+assert np.all(selected[before==1] == 1)
+assert np.sum(selected) - np.sum(before) == 3000
+assert np.all(selected[(before==0) & (probs==1.)] == 0)
+
+#same seed, same selection
+c_randomSelect.setSeed(7)
+again=before.copy()
+c_randomSelect.randSelect(probs,again,3000)
+assert np.all(again == selected)
+
+#other flag types
+for dt in ['bool','int64','float32','float64']:
+    c_randomSelect.setSeed(7)
+    flags=before.astype(dt)
+    c_randomSelect.randSelect(probs,flags,3000)
+    assert np.all(flags.astype('int32') == selected)
+
+#all candidates, not one more
+ncand=np.sum((before==0) & (probs<1))
+flags=before.copy()
+c_randomSelect.randSelect(probs,flags,int(ncand))
+assert np.all(flags[probs<1] == 1) and np.all(flags[(before==0) & (probs==1.)] == 0)
+
+flags=before.copy()
+try:
+    c_randomSelect.randSelect(probs,flags,int(ncand)+1)
+    raise AssertionError('selecting more than the candidates did not raise')
+except RuntimeError:
+    pass
+
+#weighted: of two entries, the one with weight 0.9 is picked in 90% of the cases
+npicked=0
+for i in range(2000):
+    flags=np.zeros(2,dtype='int32')
+    c_randomSelect.randSelect(np.array([0.1,0.9]),flags,1)
+    assert np.sum(flags) == 1
+    npicked+=flags[0]
+assert abs(npicked/2000. - 0.9) < 0.03
+
+
+## randKeep keeps each entry with probability 1-prob
+
+c_randomSelect.setSeed(3)
+probs=np.repeat(np.array([0.,0.25,0.5,0.875,1.]),40000)
+keeps=np.zeros(len(probs),dtype='int32')
+c_randomSelect.randKeep(probs,keeps)
+for p in [0.,0.25,0.5,0.875,1.]:
+    assert abs(keeps[probs==p].mean() - (1.-p)) < 0.01
+
+c_randomSelect.setSeed(3)
+again=np.ones(len(probs),dtype='float32')
+c_randomSelect.randKeep(probs.astype('float32'),again)
+assert np.all(again == keeps)
+
+print('randomSelect test passed')
@@ -0,0 +1,32 @@
+'''
+reads the test file with the compiled reader with and without TTreeCache:
+the results must not depend on the read options. The branch status and
+cache content are checked in compiled/to_bin/_testTreeCache.cpp
+'''
+import os
+import numpy as np
+import ROOT
+from DeepJetCore.preprocessing import MeanNormZeroPad, setTreeReadOptions
+
+infile=os.path.join(os.path.dirname(os.path.abspath(__file__)),'..','files','root_file0.root')
+
+rfile=ROOT.TFile(infile)
+nentries=rfile.Get('deepntuplizer/tree').GetEntries()
+rfile.Close()
+
+def read():
+    return MeanNormZeroPad(infile,None,[['x','class1','class2']],[1],nentries)
+
+setTreeReadOptions(0)
+expected=read()
+assert expected.shape == (nentries,3)
+
+for cachesize_mb in [-1, 1, 0.001]:
+    setTreeReadOptions(cachesize_mb)
+    assert np.all(read() == expected)
+
+setTreeReadOptions(-1, prefetch=True)
+assert np.all(read() == expected)
+setTreeReadOptions()
+
+print('tree cache test passed')
@@ -0,0 +1,132 @@
+'''
+compares the c_weighter based Weighter with the previous per-jet
+python implementation on a small structured array
+'''
+import numpy as np
+from DeepJetCore.Weighter import Weighter
+
+
+## previous python implementation, per jet
+
+def ref_getBin(value, bins):
+    for index, bin in enumerate (bins):
+        if value < bin:
+            return index-1
+    return bins.size-2
+
+def ref_addDistributions(w, Tuple, norm_h = True):
+    distributions=[]
+    for c in w.classes:
+        sel=Tuple[c]>0
+        tmphist,_,_=np.histogram2d(Tuple[w.nameX][sel],Tuple[w.nameY][sel],[w.axisX,w.axisY],density=norm_h)
+        distributions.append(tmphist)
+    return distributions
+
+def ref_getJetWeights(w, Tuple):
+    weight = np.zeros(len(Tuple))
+    for jetcount, jet in enumerate(Tuple):
+        binX = ref_getBin(jet[w.nameX], w.axisX)
+        binY = ref_getBin(jet[w.nameY], w.axisY)
+        for index, classs in enumerate(w.classes):
+            if 1 == jet[classs]:
+                weight[jetcount]=w.binweights[index][binX][binY]
+    return weight
+
+def ref_createNotRemoveIndices(w, Tuple):
+    #only for remove probabilities of 0 or 1, the random numbers differ
+    notremove=np.zeros(len(Tuple))
+    for counter, jet in enumerate(Tuple):
+        binX = ref_getBin(jet[w.nameX], w.axisX)
+        binY = ref_getBin(jet[w.nameY], w.axisY)
+        for index, classs in enumerate(w.classes):
+            if 1 == jet[classs]:
+                prob = w.removeProbabilties[index][binX][binY]
+                if prob >= 1 and index != w.refclassidx:
+                    notremove[counter]=0
+                else:
+                    notremove[counter]=1
+                break
+    return notremove
+
+
+## data: some jets outside the axes, in several or in no class
+
+np.random.seed(42)
+njets=2000
+classes=['isB','isC','isUDSG']
+Tuple=np.zeros(njets,dtype=[('jet_pt','float64'),('jet_eta','float64'),
+                            ('isB','float32'),('isC','float32'),('isUDSG','float32')])
+Tuple['jet_pt']  = np.random.uniform(0, 1200, njets)
+Tuple['jet_eta'] = np.random.uniform(-3, 3, njets)
+for i in range(njets):
+    Tuple[classes[i%3]][i]=1
+Tuple['isC'][::7]=1    #B or UDSG jets that are C jets as well
+Tuple['isB'][5::11]=0  #jets without any class
+Tuple['isC'][5::11]=0
+Tuple['isUDSG'][5::11]=0
+
+ptbins=np.array([20,40,60,100,200,400,1000],dtype='float64')
+etabins=np.array([-2.5,-1.,0.,1.,2.5],dtype='float64')
+
+#underflow and overflow are mapped to the last bin
+assert ref_getBin(5., ptbins) == -1
+assert ref_getBin(1100., ptbins) == ptbins.size-2
+
+w=Weighter()
+w.setBinningAndClasses([ptbins,etabins],'jet_pt','jet_eta',classes)
+
+
+## histograms, density normalised per class as numpy.histogram2d
+
+w.addDistributions(Tuple)
+for new,ref in zip(w.distributions, ref_addDistributions(w, Tuple)):
+    assert np.allclose(new, ref)
+    assert np.isclose((new*np.outer(np.diff(ptbins),np.diff(etabins))).sum(), 1.)
+
+w.addDistributions(Tuple)#adds up
+for new,ref in zip(w.distributions, ref_addDistributions(w, Tuple)):
+    assert np.allclose(new, 2*ref)
+
+w2=Weighter()
+w2.setBinningAndClasses([ptbins,etabins],'jet_pt','jet_eta',classes)
+w2.addDistributions(Tuple, norm_h=False)
+for new,ref in zip(w2.distributions, ref_addDistributions(w2, Tuple, False)):
+    assert np.all(new == ref)
+
+
+## weights, the last class of the jet wins
+
+w.createRemoveProbabilitiesAndWeights('isB')
+assert np.allclose(w.getJetWeights(Tuple), ref_getJetWeights(w, Tuple))
+
+#distinct weights per class and bin, so any wrong bin or class shows up
+nbins=(len(ptbins)-1)*(len(etabins)-1)
+w.binweights=[np.arange(nbins,dtype='float64').reshape(len(ptbins)-1,-1)+100*(c+1) for c in range(3)]
+weights=w.getJetWeights(Tuple)
+assert np.all(weights == ref_getJetWeights(w, Tuple))
+assert np.all(weights[5::11] == 0)
+both=(Tuple['isB']==1) & (Tuple['isC']==1)
+assert np.any(both) and np.all(weights[both] >= 200) and np.all(weights[both] < 300)
+
+
+## remove flags, the first class of the jet decides
+
+#remove all jets of one class and each second bin of another
+w.removeProbabilties=[np.zeros((len(ptbins)-1,len(etabins)-1)) for _ in range(3)]
+w.removeProbabilties[1][:]=1
+w.removeProbabilties[2][::2]=1
+w.removeProbabilties[0][:]=1 #reference class, always kept
+notremove=w.createNotRemoveIndices(Tuple)
+assert np.all(notremove == ref_createNotRemoveIndices(w, Tuple))
+assert np.all(notremove[5::11] == 0)
+assert np.all(notremove[both] == 1)
+
+#probabilities in between: removed fraction as expected
+w.removeProbabilties=[np.zeros((len(ptbins)-1,len(etabins)-1))+0.3 for _ in range(3)]
+big=np.concatenate([Tuple]*50)
+notremove=w.createNotRemoveIndices(big)
+nonref=(big['isB']!=1) & ((big['isC']==1) | (big['isUDSG']==1))
+assert abs(1.-notremove[nonref].mean() - 0.3) < 0.02
+assert np.all(notremove[big['isB']==1] == 1)
+
+print('Weighter test passed')